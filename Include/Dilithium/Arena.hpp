@@ -0,0 +1,109 @@
+/**
+ * @file Arena.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of Dilithium
+ * For the latest info, see https://github.com/gongminmin/Dilithium
+ *
+ * @section LICENSE
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Minmin Gong. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _DILITHIUM_ARENA_HPP
+#define _DILITHIUM_ARENA_HPP
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <boost/core/noncopyable.hpp>
+
+namespace Dilithium
+{
+	// Hands out memory from a few large slabs. A freed block goes to the free list of its size, to be reused by the next
+	// allocation of that size. The slabs are only returned, all at once, when the arena goes away.
+	//
+	// Dropping the arena doesn't skip the teardown of what lives in it. Values and metadata own heap memory of their
+	// own, such as names, operand lists and value handles, so each one is still destroyed and deallocated on its own.
+	// What the arena saves is a heap call per allocation and per free, and with Release the free list updates of a
+	// teardown, but not the walk over the objects.
+	class Arena : boost::noncopyable
+	{
+	public:
+		static uint32_t constexpr SLAB_SIZE = 64 * 1024;
+		static uint32_t constexpr ALIGNMENT = 8;
+		// Larger blocks aren't recycled. They get a slab of their own if they don't fit in a regular one.
+		static uint32_t constexpr MAX_RECYCLED_SIZE = 512;
+
+	public:
+		Arena();
+		~Arena();
+
+		void* Allocate(size_t size);
+		void Deallocate(void* p, size_t size);
+
+		// From now on, freed blocks aren't put back on the free lists, since the slabs are about to go anyway. For the
+		// teardown of the owner. Allocating still works, it just can't reuse what was freed after this.
+		void Release()
+		{
+			released_ = true;
+		}
+
+		size_t NumSlabs() const
+		{
+			return slabs_.size();
+		}
+		size_t NumBytesReserved() const
+		{
+			return num_bytes_reserved_;
+		}
+
+	private:
+		static size_t RoundUp(size_t size)
+		{
+			return (size + ALIGNMENT - 1) & ~static_cast<size_t>(ALIGNMENT - 1);
+		}
+
+		uint8_t* NewSlab(size_t size);
+
+	private:
+		std::vector<void*> slabs_;
+		uint8_t* curr_ = nullptr;
+		uint8_t* end_ = nullptr;
+		size_t num_bytes_reserved_ = 0;
+		bool released_ = false;
+
+		struct FreeBlock
+		{
+			FreeBlock* next;
+		};
+		FreeBlock* free_lists_[MAX_RECYCLED_SIZE / ALIGNMENT] = {};
+	};
+}
+
+#endif		// _DILITHIUM_ARENA_HPP
@@ -37,13 +37,14 @@
 
 #pragma once
 
+#include <Dilithium/IList.hpp>
 #include <Dilithium/Value.hpp>
 
 namespace Dilithium
 {
 	class Function;
 
-	class Argument : public Value
+	class Argument : public Value, public IListNode<Argument>
 	{
 		typedef Function ParentType;
 
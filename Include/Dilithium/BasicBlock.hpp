@@ -37,19 +37,17 @@
 
 #pragma once
 
+#include <Dilithium/IList.hpp>
 #include <Dilithium/Instruction.hpp>
 #include <Dilithium/Value.hpp>
 
-#include <list>
-#include <memory>
-
 namespace Dilithium
 {
 	class Function;
 	class LLVMContext;
 	class ValueSymbolTable;
 
-	class BasicBlock : public Value
+	class BasicBlock : public Value, public IListNode<BasicBlock>
 	{
 		typedef Function ParentType;
 
@@ -59,7 +57,7 @@ namespace Dilithium
 		friend void RemoveFromSymbolTableList(NodeType*);
 
 	public:
-		typedef std::list<std::unique_ptr<Instruction>> InstListType;
+		typedef IList<Instruction> InstListType;
 		typedef InstListType::iterator iterator;
 		typedef InstListType::const_iterator const_iterator;
 		typedef InstListType::reverse_iterator reverse_iterator;
@@ -123,19 +121,19 @@ namespace Dilithium
 		}
 		Instruction const & front() const
 		{
-			return *inst_list_.front();
+			return inst_list_.front();
 		}
 		Instruction& front()
 		{
-			return *inst_list_.front();
+			return inst_list_.front();
 		}
 		Instruction const & back() const
 		{
-			return *inst_list_.back();
+			return inst_list_.back();
 		}
 		Instruction& back()
 		{
-			return *inst_list_.back();
+			return inst_list_.back();
 		}
 
 		InstListType const & InstList() const
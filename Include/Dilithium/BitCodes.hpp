@@ -229,6 +229,28 @@ namespace Dilithium
 	/// specialized format instead of the fully-general, fully-vbr, format.
 	class BitCodeAbbrev
 	{
+	public:
+		/// DecodeStep - One instruction of the flat decode program an abbreviation is
+		/// compiled into. An array and its element encoding are fused into a single step.
+		struct DecodeStep
+		{
+			enum class Kind : uint8_t
+			{
+				Literal,
+				Fixed,
+				VBR,
+				Char6,
+				ArrayFixed,
+				ArrayVBR,
+				ArrayChar6,
+				Blob
+			};
+
+			Kind kind;
+			uint32_t width;
+			uint64_t literal;
+		};
+
 	public:
 		~BitCodeAbbrev() = default;
 
@@ -247,8 +269,126 @@ namespace Dilithium
 			operand_list_.push_back(op_info);
 		}
 
+		// Validates the operand list and turns it into the decode program. Called once, when the abbreviation is defined.
+		void Compile()
+		{
+			if (operand_list_.empty())
+			{
+				ReportFatalError("Abbrev record with no operands");
+			}
+			if (operand_list_[0].IsEncoding()
+				&& ((operand_list_[0].Encoding() == BitCodeAbbrevOp::BitCodeEncoding::Array)
+					|| (operand_list_[0].Encoding() == BitCodeAbbrevOp::BitCodeEncoding::Blob)))
+			{
+				ReportFatalError("Abbreviation starts with an Array or a Blob");
+			}
+
+			decode_steps_.clear();
+			for (uint32_t i = 0, e = this->NumOperandInfos(); i != e; ++ i)
+			{
+				auto const & op = operand_list_[i];
+
+				DecodeStep step;
+				step.width = 0;
+				step.literal = 0;
+				if (op.IsLiteral())
+				{
+					step.kind = DecodeStep::Kind::Literal;
+					step.literal = op.LiteralValue();
+					decode_steps_.push_back(step);
+					continue;
+				}
+
+				switch (op.Encoding())
+				{
+				case BitCodeAbbrevOp::BitCodeEncoding::Fixed:
+				case BitCodeAbbrevOp::BitCodeEncoding::VBR:
+				case BitCodeAbbrevOp::BitCodeEncoding::Char6:
+					this->EncodingStep(op, step);
+					break;
+
+				case BitCodeAbbrevOp::BitCodeEncoding::Array:
+					{
+						if (i + 2 != e)
+						{
+							ReportFatalError("Array op not second to last");
+						}
+						++ i;
+						auto const & elem_enc = operand_list_[i];
+						if (!elem_enc.IsEncoding())
+						{
+							ReportFatalError("Array element type has to be an encoding of a type");
+						}
+						if ((elem_enc.Encoding() == BitCodeAbbrevOp::BitCodeEncoding::Array)
+							|| (elem_enc.Encoding() == BitCodeAbbrevOp::BitCodeEncoding::Blob))
+						{
+							ReportFatalError("Array element type can't be an Array or a Blob");
+						}
+
+						this->EncodingStep(elem_enc, step);
+						switch (step.kind)
+						{
+						case DecodeStep::Kind::Fixed:
+							step.kind = DecodeStep::Kind::ArrayFixed;
+							break;
+						case DecodeStep::Kind::VBR:
+							step.kind = DecodeStep::Kind::ArrayVBR;
+							break;
+						default:
+							step.kind = DecodeStep::Kind::ArrayChar6;
+							break;
+						}
+					}
+					break;
+
+				case BitCodeAbbrevOp::BitCodeEncoding::Blob:
+					step.kind = DecodeStep::Kind::Blob;
+					break;
+
+				default:
+					ReportFatalError("Invalid abbreviation encoding");
+				}
+
+				decode_steps_.push_back(step);
+			}
+		}
+
+		uint32_t NumDecodeSteps() const
+		{
+			return static_cast<uint32_t>(decode_steps_.size());
+		}
+
+		DecodeStep const * DecodeSteps() const
+		{
+			return decode_steps_.data();
+		}
+
+	private:
+		static void EncodingStep(BitCodeAbbrevOp const & op, DecodeStep& step)
+		{
+			switch (op.Encoding())
+			{
+			case BitCodeAbbrevOp::BitCodeEncoding::Fixed:
+				step.kind = DecodeStep::Kind::Fixed;
+				step.width = static_cast<uint32_t>(op.EncodingData());
+				break;
+			case BitCodeAbbrevOp::BitCodeEncoding::VBR:
+				step.kind = DecodeStep::Kind::VBR;
+				step.width = static_cast<uint32_t>(op.EncodingData());
+				break;
+			case BitCodeAbbrevOp::BitCodeEncoding::Char6:
+				step.kind = DecodeStep::Kind::Char6;
+				step.width = 6;
+				break;
+
+			default:
+				DILITHIUM_UNREACHABLE("Not a scalar encoding");
+			}
+		}
+
 	private:
 		boost::container::small_vector<BitCodeAbbrevOp, 32> operand_list_;
+		boost::container::small_vector<DecodeStep, 8> decode_steps_;
 	};
 }
 
@@ -0,0 +1,110 @@
+/**
+ * @file BitcodeBlockIndex.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of Dilithium
+ * For the latest info, see https://github.com/gongminmin/Dilithium
+ *
+ * @section LICENSE
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Minmin Gong. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef _DILITHIUM_BITCODE_BLOCK_INDEX_HPP
+#define _DILITHIUM_BITCODE_BLOCK_INDEX_HPP
+
+#pragma once
+
+#include <Dilithium/Util.hpp>
+
+#include <vector>
+
+namespace Dilithium
+{
+	// Where every block of a bitcode module is. It's built by a quick pass that jumps over block bodies instead of
+	// decoding them, and can be kept around (Serialize/Deserialize) to skip that pass when the same bitcode is loaded
+	// again.
+	class BitcodeBlockIndex
+	{
+	public:
+		struct Block
+		{
+			uint32_t block_id;
+			uint32_t parent;		// Index of the enclosing block, or NO_PARENT.
+			uint64_t bit_offset;	// Right after the block ID, where EnterSubBlock or SkipBlock takes over.
+			uint64_t num_bits;		// From bit_offset to the end of the block.
+		};
+
+		static uint32_t constexpr NO_PARENT = ~0U;
+
+	public:
+		BitcodeBlockIndex()
+		{
+		}
+
+		// Takes the same data as LoadLLVMModule. Function bodies are skipped as a whole, unless index_function_blocks is
+		// true. In that case their records are walked to index the blocks nested in them too.
+		BitcodeBlockIndex(uint8_t const * data, uint32_t data_length, bool index_function_blocks = false);
+
+		// Size of the bitstream the offsets refer to, without a wrapper header.
+		uint32_t BitcodeLength() const
+		{
+			return bitcode_length_;
+		}
+		// A hash of the content of that bitstream. It's stable across platforms, so it can be serialized.
+		uint64_t BitcodeHash() const
+		{
+			return bitcode_hash_;
+		}
+		// True if the index was built from this bitstream, without a wrapper header. Hashes all of it.
+		bool Matches(uint8_t const * bitcode, uint32_t bitcode_length) const;
+
+		uint32_t NumBlocks() const
+		{
+			return static_cast<uint32_t>(blocks_.size());
+		}
+		Block const & GetBlock(uint32_t index) const
+		{
+			return blocks_[index];
+		}
+
+		// Returns the index of the block at bit_offset, or NumBlocks() if there is none.
+		uint32_t FindBlockAt(uint64_t bit_offset) const;
+		// Returns the index of the first block with block_id directly inside parent, starting from start. NumBlocks() if
+		// there is none.
+		uint32_t FindChild(uint32_t parent, uint32_t block_id, uint32_t start = 0) const;
+
+		std::vector<uint8_t> Serialize() const;
+		static BitcodeBlockIndex Deserialize(uint8_t const * data, size_t data_length);
+
+	private:
+		uint32_t bitcode_length_ = 0;
+		uint64_t bitcode_hash_ = 0;
+		std::vector<Block> blocks_;	// In stream order, parents before their children.
+	};
+}
+
+#endif		// _DILITHIUM_BITCODE_BLOCK_INDEX_HPP
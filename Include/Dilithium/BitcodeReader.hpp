@@ -37,14 +37,111 @@
 
 #pragma once
 
+#include <Dilithium/Util.hpp>
+
+#include <iosfwd>
 #include <memory>
 #include <string>
 
 namespace Dilithium
 {
+	class BitcodeBlockIndex;
+	class LLVMContextPrelude;
 	class LLVMModule;
+	class MappedFile;
+
+	// The bitcode wrapper header, magic number 0x0B17C0DE stored in little endian.
+	bool IsBitcodeWrapper(uint8_t const * buf_beg, uint8_t const * buf_end);
+	bool SkipBitcodeWrapperHeader(uint8_t const *& buf_beg, uint8_t const *& buf_end, bool verify_buff_size);
+
+	enum class BitcodeLoadMode
+	{
+		Full,
+		Lazy,			// Function bodies are parsed on first access, or by LLVMModule::Materialize.
+		WithoutBodies	// Function bodies are skipped, only the module-level blocks are parsed. The functions are left
+						// as declarations. That's all the DxilModule needs, at a fraction of the cost of a full load.
+	};
+
+	// Where the bitcode is read from.
+	class BitcodeSource
+	{
+	public:
+		// [data, data + data_length). The data has to stay valid as long as the module, unless it is fully loaded.
+		BitcodeSource(uint8_t const * data, uint32_t data_length);
+		// A range of file, read without copying. The file stays mapped while the module needs it.
+		BitcodeSource(std::shared_ptr<MappedFile> const & file, uint8_t const * data, uint32_t data_length);
+		// All of file.
+		explicit BitcodeSource(std::shared_ptr<MappedFile> const & file);
+		// data_length bytes of raw bitcode, read from source as parsing gets to them. The module-level blocks are
+		// parsed while later function bodies are still arriving. The bitcode already parsed is dropped along the way,
+		// and nothing after it is read from source. Only full loads take a stream.
+		BitcodeSource(std::istream& source, uint32_t data_length);
+
+		uint8_t const * Data() const
+		{
+			return data_;
+		}
+		uint32_t DataLength() const
+		{
+			return data_length_;
+		}
+		std::shared_ptr<MappedFile> const & File() const
+		{
+			return file_;
+		}
+		std::istream* Stream() const
+		{
+			return stream_;
+		}
+
+	private:
+		std::shared_ptr<MappedFile> file_;
+		std::istream* stream_ = nullptr;
+		uint8_t const * data_ = nullptr;
+		uint32_t data_length_ = 0;
+	};
+
+	struct LoadOptions
+	{
+		BitcodeLoadMode mode = BitcodeLoadMode::Full;
+		// Built from the same bitcode, used to find the function bodies. The load fails if the length or the content
+		// hash of the bitcode differ. It has to outlive the parsing, including the lazy parsing of function bodies.
+		BitcodeBlockIndex const * block_index = nullptr;
+		// The context of the module shares the prelude's objects instead of creating them again.
+		std::shared_ptr<LLVMContextPrelude const> prelude;
+		// A full load decodes the function bodies on up to this many threads, the caller's included, before building
+		// their IR serially. 1 decodes them on the caller's thread only. The decoded bodies are held until their IR is
+		// built, and take several times the memory of their bitcode. That's bounded by decoding up to 1 MB of bitcode
+		// at a time, but it still comes on top of the module.
+		uint32_t num_decode_threads = 1;
+	};
+
+	// Every load creates a context for its module.
+	std::unique_ptr<LLVMModule> LoadLLVMModule(BitcodeSource const & source, std::string const & name,
+		LoadOptions const & options = LoadOptions());
 
-	std::unique_ptr<LLVMModule> LoadLLVMModule(uint8_t const * data, uint32_t data_length, std::string const & name);
+	// Shorthands for the common cases of the load above.
+	std::unique_ptr<LLVMModule> LoadLLVMModule(uint8_t const * data, uint32_t data_length, std::string const & name,
+		std::shared_ptr<LLVMContextPrelude const> const & prelude = nullptr, uint32_t num_decode_threads = 1);
+	std::unique_ptr<LLVMModule> LoadLLVMModule(uint8_t const * data, uint32_t data_length, std::string const & name,
+		BitcodeBlockIndex const & block_index, std::shared_ptr<LLVMContextPrelude const> const & prelude = nullptr,
+		uint32_t num_decode_threads = 1);
+	std::unique_ptr<LLVMModule> LoadLLVMModule(std::shared_ptr<MappedFile> const & file, uint8_t const * data,
+		uint32_t data_length, std::string const & name, std::shared_ptr<LLVMContextPrelude const> const & prelude = nullptr,
+		uint32_t num_decode_threads = 1);
+	// Maps the bitcode file file_name read-only and reads it without copying.
+	std::unique_ptr<LLVMModule> LoadLLVMModuleFromFile(std::string const & file_name, std::string const & name,
+		std::shared_ptr<LLVMContextPrelude const> const & prelude = nullptr, uint32_t num_decode_threads = 1);
+	std::unique_ptr<LLVMModule> LoadLazyLLVMModule(uint8_t const * data, uint32_t data_length, std::string const & name,
+		std::shared_ptr<LLVMContextPrelude const> const & prelude = nullptr);
+	std::unique_ptr<LLVMModule> LoadLazyLLVMModule(std::shared_ptr<MappedFile> const & file, uint8_t const * data,
+		uint32_t data_length, std::string const & name, std::shared_ptr<LLVMContextPrelude const> const & prelude = nullptr);
+	std::unique_ptr<LLVMModule> LoadLLVMModuleWithoutBodies(uint8_t const * data, uint32_t data_length,
+		std::string const & name, std::shared_ptr<LLVMContextPrelude const> const & prelude = nullptr);
+	std::unique_ptr<LLVMModule> LoadLLVMModuleWithoutBodies(std::shared_ptr<MappedFile> const & file, uint8_t const * data,
+		uint32_t data_length, std::string const & name, std::shared_ptr<LLVMContextPrelude const> const & prelude = nullptr);
+	std::unique_ptr<LLVMModule> LoadLLVMModule(std::istream& source, uint32_t data_length, std::string const & name,
+		std::shared_ptr<LLVMContextPrelude const> const & prelude = nullptr);
 }
 
 #endif		// _DILITHIUM_BITCODE_READER_HPP
@@ -39,13 +39,16 @@
 
 #include <Dilithium/CXX17/string_view.hpp>
 #include <Dilithium/BitCodes.hpp>
+#include <Dilithium/ChunkedStreamBuf.hpp>
 #include <Dilithium/MemStreamBuf.hpp>
 
 #include <climits>
+#include <istream>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include <boost/assert.hpp>
 #include <boost/container/small_vector.hpp>
 #include <boost/core/noncopyable.hpp>
 #include <boost/endian/conversion.hpp>
@@ -58,7 +61,7 @@ namespace Dilithium
 		struct BlockInfo
 		{
 			uint32_t block_id;
-			std::vector<std::shared_ptr<BitCodeAbbrev>> abbrevs;
+			std::vector<BitCodeAbbrev> abbrevs;
 			std::string name;
 
 			std::vector<std::pair<uint32_t, std::string>> record_names;
@@ -69,13 +72,25 @@ namespace Dilithium
 		{
 		}
 
+		// Reads directly from the contiguous range [beg, end). The range has to outlive the reader.
 		BitStreamReader(uint8_t const * beg, uint8_t const * end);
+		// Reads through a stream buffer. Slower than the contiguous version, but doesn't need the whole bitcode in memory.
+		BitStreamReader(std::unique_ptr<std::streambuf> buff, uint32_t size);
+		// Reads from a sequential source as the bitcode arrives. Parts that have been consumed can be dropped with Release.
+		explicit BitStreamReader(std::unique_ptr<ChunkedStreamBuf> buff);
 		BitStreamReader(BitStreamReader&& rhs);
 
 		BitStreamReader& operator=(BitStreamReader&& rhs);
 
+		// An empty contiguous range has a null start too, so this can't be keyed on bitcode_begin_.
+		bool IsStreamed() const
+		{
+			return bitcode_stream_ != nullptr;
+		}
+
 		std::istream& BitcodeStream()
 		{
+			BOOST_ASSERT(this->IsStreamed());
 			return *bitcode_stream_;
 		}
 		uint8_t const * BitcodeStart()
@@ -87,6 +102,17 @@ namespace Dilithium
 			return bitcode_size_;
 		}
 
+		bool IsChunked() const
+		{
+			return chunked_buff_ != nullptr;
+		}
+		ChunkedStreamBuf* ChunkedBuffer()
+		{
+			return chunked_buff_;
+		}
+		// Tells a chunked reader that no cursor is going back before bit_no. Does nothing for the other readers.
+		void Release(uint64_t bit_no);
+
 		bool HasBlockInfoRecords() const
 		{
 			return !block_info_records_.empty();
@@ -100,8 +126,9 @@ namespace Dilithium
 	private:
 		std::unique_ptr<std::streambuf> bitcode_buff_;
 		std::unique_ptr<std::istream> bitcode_stream_;
-		uint8_t const * bitcode_begin_;
-		uint32_t bitcode_size_;
+		ChunkedStreamBuf* chunked_buff_ = nullptr;
+		uint8_t const * bitcode_begin_ = nullptr;
+		uint32_t bitcode_size_ = 0;
 
 		std::vector<BlockInfo> block_info_records_;
 	};
@@ -131,6 +158,8 @@ namespace Dilithium
 
 	public:
 		static size_t constexpr MAX_CHUNK_SIZE = sizeof(word_t) * 8;
+		// Below this many values, ReadVBR6Array doesn't pay for re-syncing the cursor.
+		static uint32_t constexpr MIN_BULK_VBR6_VALUES = 4;
 
 		// Flags that modify the behavior of Advance().
 		enum
@@ -186,6 +215,8 @@ namespace Dilithium
 		word_t Read(uint32_t num_bits);
 		uint32_t ReadVBR(uint32_t num_bits);
 		uint64_t ReadVBR64(uint32_t num_bits);
+		// Reads num_vals consecutive VBR6 values, the operand encoding of unabbreviated records.
+		void ReadVBR6Array(uint64_t* vals, uint32_t num_vals);
 
 		uint32_t ReadCode()
 		{
@@ -204,7 +235,12 @@ namespace Dilithium
 
 		BitCodeAbbrev const * GetAbbrev(uint32_t abbrev_id);
 
-		uint32_t ReadRecord(uint32_t abbrev_id, boost::container::small_vector_base<uint64_t>& vals);
+		// If str is given, a trailing blob or array of Char6 or Fixed(<= 8) elements isn't widened into vals, but returned
+		// in str as characters. It points into the bitcode or into a scratch buffer, and is only valid until the next
+		// ReadRecord. str is set to an empty string_view if the record has no such operand. Only pass it for blocks where
+		// these arrays are strings.
+		uint32_t ReadRecord(uint32_t abbrev_id, boost::container::small_vector_base<uint64_t>& vals,
+			std::string_view* str = nullptr);
 
 		void ReadAbbrevRecord();
 		bool ReadBlockInfoBlock();
@@ -212,6 +248,9 @@ namespace Dilithium
 	private:
 		void SkipToFourByteBoundary();
 		void PopBlockScope();
+		void SetAbbrevScope(uint32_t block_id, uint32_t num_info_abbrevs, uint32_t local_abbrevs_base);
+		void FillCurrWordFromStream();
+		bool ReadBlob(boost::container::small_vector_base<uint64_t>& vals, std::string_view* blob);
 
 	private:
 		BitStreamReader* bit_stream_;
@@ -223,20 +262,31 @@ namespace Dilithium
 		uint32_t bits_in_curr_word_;
 		uint32_t curr_code_size_;
 
-		std::vector<std::shared_ptr<BitCodeAbbrev>> curr_abbrevs_;
+		// The abbreviations in scope are the first num_info_abbrevs_ ones from the BLOCKINFO of the current block,
+		// followed by the ones the block defined itself, local_abbrevs_[local_abbrevs_base_, end). Both are referenced
+		// by index, so entering and leaving a block doesn't copy abbreviations around.
+		uint32_t curr_block_id_;
+		BitCodeAbbrev const * info_abbrevs_;
+		uint32_t num_info_abbrevs_;
+		uint32_t local_abbrevs_base_;
+		std::vector<BitCodeAbbrev> local_abbrevs_;
 
 		struct Block
 		{
 			uint32_t prev_code_size;
-			std::vector<std::shared_ptr<BitCodeAbbrev>> prev_abbrevs;
+			uint32_t prev_block_id;
+			uint32_t prev_num_info_abbrevs;
+			uint32_t prev_local_abbrevs_base;
 
-			explicit Block(uint32_t pcs)
-				: prev_code_size(pcs)
+			Block(uint32_t pcs, uint32_t pbi, uint32_t pnia, uint32_t plab)
+				: prev_code_size(pcs), prev_block_id(pbi), prev_num_info_abbrevs(pnia), prev_local_abbrevs_base(plab)
 			{
 			}
 		};
 
 		boost::container::small_vector<Block, 8> block_scope_;
+
+		std::string str_scratch_;
 	};
 }
 
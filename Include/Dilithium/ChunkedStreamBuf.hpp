@@ -0,0 +1,112 @@
+/**
+ * @file ChunkedStreamBuf.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of Dilithium
+ * For the latest info, see https://github.com/gongminmin/Dilithium
+ *
+ * @section LICENSE
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Minmin Gong. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef _DILITHIUM_CHUNKED_STREAM_BUF_HPP
+#define _DILITHIUM_CHUNKED_STREAM_BUF_HPP
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <streambuf>
+#include <vector>
+
+#include <boost/core/noncopyable.hpp>
+
+namespace Dilithium
+{
+	// A seekable view of the next size bytes of a sequential source, such as a pipe. The source is pulled in chunks
+	// only when a read reaches them, and the chunks that are no longer needed can be given back with Release.
+	class ChunkedStreamBuf : boost::noncopyable, public std::streambuf
+	{
+	public:
+		static uint32_t constexpr DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+	public:
+		// Never reads more than size bytes from source, so whatever follows them can still be read from it afterwards.
+		ChunkedStreamBuf(std::istream& source, uint64_t size, uint32_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+		uint64_t Size() const
+		{
+			return size_;
+		}
+
+		// Drops the chunks that lie entirely before pos. Seeking back into them fails afterwards.
+		void Release(uint64_t pos);
+		// Skips what hasn't been fetched yet and drops everything, leaving the source right after the size bytes.
+		void Drain();
+
+		// Bytes pulled from the source so far, and how many of them are still held.
+		uint64_t NumBytesFetched() const
+		{
+			return num_bytes_fetched_;
+		}
+		uint64_t NumBytesResident() const
+		{
+			return num_bytes_fetched_ - first_chunk_pos_;
+		}
+		uint64_t PeakBytesResident() const
+		{
+			return peak_bytes_resident_;
+		}
+
+	protected:
+		virtual int_type uflow() override;
+		virtual int_type underflow() override;
+
+		virtual std::streamsize xsgetn(char_type* s, std::streamsize count) override;
+
+		virtual std::streamsize showmanyc() override;
+
+		virtual pos_type seekoff(off_type off, std::ios_base::seekdir way, std::ios_base::openmode which) override;
+		virtual pos_type seekpos(pos_type sp, std::ios_base::openmode which) override;
+
+	private:
+		char_type const * Fetch(uint64_t pos);
+
+	private:
+		std::istream& source_;
+		uint64_t size_;
+		uint32_t const chunk_size_;
+
+		std::deque<std::vector<char_type>> chunks_;
+		uint64_t first_chunk_pos_;
+		uint64_t num_bytes_fetched_;
+		uint64_t peak_bytes_resident_;
+		uint64_t current_;
+	};
+}
+#endif		// _DILITHIUM_CHUNKED_STREAM_BUF_HPP
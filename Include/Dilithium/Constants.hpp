@@ -84,6 +84,11 @@ namespace Dilithium
 		static Constant* Get(Type* ty, std::string_view str);
 		static ConstantFP* Get(LLVMContext& context, MPFloat const & v);
 
+		MPFloat const & ValueMPF() const
+		{
+			return val_;
+		}
+
 		static bool classof(Value const * val)
 		{
 			return val->GetValueId() == ConstantFPVal;
@@ -52,8 +52,12 @@ namespace Dilithium
 	DILITHIUM_ATTRIBUTE_NORETURN void UnreachableInternal(char const * msg = nullptr, char const * file = nullptr, uint32_t line = 0);
 
 	#define DILITHIUM_UNREACHABLE(msg) ::Dilithium::UnreachableInternal(msg, __FILE__, __LINE__)
+	// The parts of the reader that aren't implemented yet throw, so an input that needs them can be skipped. Otherwise
+	// reaching them is undefined behavior, and nothing that might should be parsed.
+	#define DILITHIUM_UNREACHABLE_THROWS 1
 #else
 	#define DILITHIUM_UNREACHABLE(msg) DILITHIUM_BUILTIN_UNREACHABLE
+	#define DILITHIUM_UNREACHABLE_THROWS 0
 #endif
 
 	#define DILITHIUM_NOT_IMPLEMENTED DILITHIUM_UNREACHABLE("Not implemented")
@@ -44,11 +44,11 @@
 #include <Dilithium/CallingConv.hpp>
 #include <Dilithium/Casting.hpp>
 #include <Dilithium/GlobalObject.hpp>
+#include <Dilithium/IList.hpp>
 #include <Dilithium/OperandTraits.hpp>
 #include <Dilithium/ValueSymbolTable.hpp>
 #include <Dilithium/Value.hpp>
 
-#include <list>
 #include <memory>
 
 namespace Dilithium
@@ -63,7 +63,7 @@ namespace Dilithium
 	{
 	};
 
-	class Function : public GlobalObject
+	class Function : public GlobalObject, public IListNode<Function>
 	{
 		typedef LLVMModule ParentType;
 
@@ -80,11 +80,11 @@ namespace Dilithium
 		};
 
 	public:
-		typedef std::list<std::unique_ptr<Argument>> ArgumentListType;
+		typedef IList<Argument> ArgumentListType;
 		typedef ArgumentListType::iterator arg_iterator;
 		typedef ArgumentListType::const_iterator const_arg_iterator;
 
-		typedef std::list<std::unique_ptr<BasicBlock>> BasicBlockListType;
+		typedef IList<BasicBlock> BasicBlockListType;
 		typedef BasicBlockListType::iterator iterator;
 		typedef BasicBlockListType::const_iterator const_iterator;
 
@@ -122,12 +122,18 @@ namespace Dilithium
 		ArgumentListType const & ArgumentList() const;
 		ArgumentListType& ArgumentList();
 
+		// The basic block accessors parse a lazily loaded body on first use, the const ones too. That changes the
+		// function and its module, so a function that isn't materialized can't be read from several threads at once.
+		// Call LLVMModule::Materialize first to share it. If the body fails to parse, the accessor throws and the function
+		// is left without blocks and still materializable, so the next access throws again.
 		BasicBlockListType const & BasicBlockList() const
 		{
+			this->CheckMaterialized();
 			return basic_blocks_;
 		}
 		BasicBlockListType& BasicBlockList()
 		{
+			this->CheckMaterialized();
 			return basic_blocks_;
 		}
 
@@ -142,44 +148,54 @@ namespace Dilithium
 
 		iterator begin()
 		{
+			this->CheckMaterialized();
 			return basic_blocks_.begin();
 		}
 		const_iterator begin() const
 		{
+			this->CheckMaterialized();
 			return basic_blocks_.begin();
 		}
 		iterator end()
 		{
+			this->CheckMaterialized();
 			return basic_blocks_.end();
 		}
 		const_iterator end() const
 		{
+			this->CheckMaterialized();
 			return basic_blocks_.end();
 		}
 
 		size_t size() const
 		{
+			this->CheckMaterialized();
 			return basic_blocks_.size();
 		}
 		bool empty() const
 		{
+			this->CheckMaterialized();
 			return basic_blocks_.empty();
 		}
 		BasicBlock const & front() const
 		{
-			return *basic_blocks_.front();
+			this->CheckMaterialized();
+			return basic_blocks_.front();
 		}
 		BasicBlock& front()
 		{
-			return *basic_blocks_.front();
+			this->CheckMaterialized();
+			return basic_blocks_.front();
 		}
 		BasicBlock const & back() const
 		{
-			return *basic_blocks_.back();
+			this->CheckMaterialized();
+			return basic_blocks_.back();
 		}
 		BasicBlock& back()
 		{
-			return *basic_blocks_.back();
+			this->CheckMaterialized();
+			return basic_blocks_.back();
 		}
 
 		arg_iterator ArgBegin();
@@ -225,6 +241,9 @@ namespace Dilithium
 		}
 		void CheckLazyArguments() const;
 		void BuildLazyArguments() const;
+		// Lazily loaded bodies are parsed the first time the basic blocks are accessed. Const accessors get there
+		// through const_cast, like the lazy arguments.
+		void CheckMaterialized() const;
 
 		void SetValueSubclassData(uint16_t d)
 		{
@@ -0,0 +1,312 @@
+/**
+ * @file IList.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of Dilithium
+ * For the latest info, see https://github.com/gongminmin/Dilithium
+ *
+ * @section LICENSE
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Minmin Gong. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _DILITHIUM_ILIST_HPP
+#define _DILITHIUM_ILIST_HPP
+
+#pragma once
+
+#include <Dilithium/Util.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#include <boost/assert.hpp>
+#include <boost/core/noncopyable.hpp>
+
+namespace Dilithium
+{
+	template <typename T>
+	class IList;
+	template <typename T>
+	class IListIterator;
+
+	// The links of an element in an IList. Derive from it to make a class listable. The links aren't copied with the
+	// element.
+	template <typename T>
+	class IListNode
+	{
+		friend class IList<T>;
+		template <typename U>
+		friend class IListIterator;
+
+	protected:
+		IListNode()
+			: prev_(nullptr), next_(nullptr)
+		{
+		}
+		IListNode(IListNode const & rhs)
+			: prev_(nullptr), next_(nullptr)
+		{
+			DILITHIUM_UNUSED(rhs);
+		}
+		IListNode& operator=(IListNode const & rhs)
+		{
+			DILITHIUM_UNUSED(rhs);
+			return *this;
+		}
+
+	private:
+		IListNode* prev_;
+		IListNode* next_;
+	};
+
+	template <typename T>
+	class IListIterator
+	{
+		template <typename U>
+		friend class IListIterator;
+		friend class IList<typename std::remove_const<T>::type>;
+
+		typedef typename std::conditional<std::is_const<T>::value,
+			IListNode<typename std::remove_const<T>::type> const, IListNode<T>>::type NodeType;
+
+	public:
+		typedef std::bidirectional_iterator_tag iterator_category;
+		typedef typename std::remove_const<T>::type value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef T* pointer;
+		typedef T& reference;
+
+	public:
+		IListIterator()
+			: node_(nullptr)
+		{
+		}
+		explicit IListIterator(NodeType* node)
+			: node_(node)
+		{
+		}
+		template <typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+		IListIterator(IListIterator<U> const & rhs)
+			: node_(rhs.node_)
+		{
+		}
+
+		reference operator*() const
+		{
+			return *static_cast<T*>(node_);
+		}
+		pointer operator->() const
+		{
+			return static_cast<T*>(node_);
+		}
+
+		IListIterator& operator++()
+		{
+			node_ = node_->next_;
+			return *this;
+		}
+		IListIterator operator++(int)
+		{
+			IListIterator tmp = *this;
+			node_ = node_->next_;
+			return tmp;
+		}
+		IListIterator& operator--()
+		{
+			node_ = node_->prev_;
+			return *this;
+		}
+		IListIterator operator--(int)
+		{
+			IListIterator tmp = *this;
+			node_ = node_->prev_;
+			return tmp;
+		}
+
+		friend bool operator==(IListIterator const & lhs, IListIterator const & rhs)
+		{
+			return lhs.node_ == rhs.node_;
+		}
+		friend bool operator!=(IListIterator const & lhs, IListIterator const & rhs)
+		{
+			return lhs.node_ != rhs.node_;
+		}
+
+	private:
+		NodeType* node_;
+	};
+
+	// A doubly linked list that threads through its elements instead of allocating nodes, like LLVM's iplist. It owns
+	// the elements: erase and clear delete them, remove hands one back to the caller.
+	template <typename T>
+	class IList : boost::noncopyable
+	{
+	public:
+		typedef IListIterator<T> iterator;
+		typedef IListIterator<T const> const_iterator;
+		typedef std::reverse_iterator<iterator> reverse_iterator;
+		typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+	public:
+		IList()
+		{
+			sentinel_.prev_ = &sentinel_;
+			sentinel_.next_ = &sentinel_;
+		}
+		~IList()
+		{
+			this->clear();
+		}
+
+		iterator begin()
+		{
+			return iterator(sentinel_.next_);
+		}
+		const_iterator begin() const
+		{
+			return const_iterator(sentinel_.next_);
+		}
+		iterator end()
+		{
+			return iterator(&sentinel_);
+		}
+		const_iterator end() const
+		{
+			return const_iterator(&sentinel_);
+		}
+
+		reverse_iterator rbegin()
+		{
+			return reverse_iterator(this->end());
+		}
+		const_reverse_iterator rbegin() const
+		{
+			return const_reverse_iterator(this->end());
+		}
+		reverse_iterator rend()
+		{
+			return reverse_iterator(this->begin());
+		}
+		const_reverse_iterator rend() const
+		{
+			return const_reverse_iterator(this->begin());
+		}
+
+		size_t size() const
+		{
+			return size_;
+		}
+		bool empty() const
+		{
+			return size_ == 0;
+		}
+
+		T& front()
+		{
+			BOOST_ASSERT_MSG(!this->empty(), "Called front() on empty list!");
+			return *this->begin();
+		}
+		T const & front() const
+		{
+			BOOST_ASSERT_MSG(!this->empty(), "Called front() on empty list!");
+			return *this->begin();
+		}
+		T& back()
+		{
+			BOOST_ASSERT_MSG(!this->empty(), "Called back() on empty list!");
+			return *this->rbegin();
+		}
+		T const & back() const
+		{
+			BOOST_ASSERT_MSG(!this->empty(), "Called back() on empty list!");
+			return *this->rbegin();
+		}
+
+		// Links val in front of where, and takes the ownership of it.
+		iterator insert(iterator where, T* val)
+		{
+			IListNode<T>* node = val;
+			BOOST_ASSERT_MSG(!node->prev_ && !node->next_, "The element is already in a list!");
+
+			IListNode<T>* next = where.node_;
+			IListNode<T>* prev = next->prev_;
+			node->prev_ = prev;
+			node->next_ = next;
+			prev->next_ = node;
+			next->prev_ = node;
+			++ size_;
+			return iterator(node);
+		}
+		void push_front(T* val)
+		{
+			this->insert(this->begin(), val);
+		}
+		void push_back(T* val)
+		{
+			this->insert(this->end(), val);
+		}
+
+		// Unlinks the element at where, without deleting it.
+		T* remove(iterator where)
+		{
+			BOOST_ASSERT_MSG(where != this->end(), "Cannot remove end()!");
+
+			IListNode<T>* node = where.node_;
+			node->prev_->next_ = node->next_;
+			node->next_->prev_ = node->prev_;
+			node->prev_ = nullptr;
+			node->next_ = nullptr;
+			-- size_;
+			return static_cast<T*>(node);
+		}
+		T* remove(T* val)
+		{
+			return this->remove(iterator(val));
+		}
+
+		iterator erase(iterator where)
+		{
+			iterator next = where;
+			++ next;
+			delete this->remove(where);
+			return next;
+		}
+		void clear()
+		{
+			while (!this->empty())
+			{
+				this->erase(this->begin());
+			}
+		}
+
+	private:
+		IListNode<T> sentinel_;
+		size_t size_ = 0;
+	};
+}
+
+#endif		// _DILITHIUM_ILIST_HPP
@@ -37,6 +37,7 @@
 
 #pragma once
 
+#include <Dilithium/IList.hpp>
 #include <Dilithium/User.hpp>
 #include <Dilithium/Value.hpp>
 
@@ -44,7 +45,7 @@ namespace Dilithium
 {
 	class BasicBlock;
 
-	class Instruction : public User
+	class Instruction : public User, public IListNode<Instruction>
 	{
 		typedef BasicBlock ParentType;
 
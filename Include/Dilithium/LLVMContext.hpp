@@ -39,6 +39,8 @@
 
 #include <Dilithium/CXX17/string_view.hpp>
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 
 #include <boost/container/small_vector.hpp>
@@ -46,12 +48,18 @@
 
 namespace Dilithium
 {
+	class LLVMContextPrelude;
 	struct LLVMContextImpl;
 
 	class LLVMContext : boost::noncopyable
 	{
 	public:
-		LLVMContext();
+		// With use_arena, the values and metadata of the context are allocated from an arena, and their memory goes back
+		// to the heap in bulk along with it. They are still destroyed one by one.
+		explicit LLVMContext(bool use_arena = true);
+		// Metadata kinds, attributes and MDStrings are looked up in prelude first, and only the ones missing there are
+		// created in this context. Types, values and the rest of metadata always belong to this context.
+		explicit LLVMContext(std::shared_ptr<LLVMContextPrelude const> const & prelude, bool use_arena = true);
 		~LLVMContext();
 
 		// Pinned metadata names, which always have the same value.  This is a
@@ -81,10 +89,42 @@ namespace Dilithium
 		{
 			return *impl_;
 		}
+		LLVMContextImpl const & Impl() const
+		{
+			return *impl_;
+		}
+
+		// Memory for a value or metadata object of this context. The block remembers where it comes from, so it can be
+		// freed without the context at hand.
+		void* AllocateObject(size_t size);
+		static void DeallocateObject(void* p, size_t size);
 
 	private:
+		void CreateFixedMdKinds();
+
+	private:
+		// Declared first, so it outlives the objects of impl_ that refer to it.
+		std::shared_ptr<LLVMContextPrelude const> prelude_;
 		std::unique_ptr<LLVMContextImpl> impl_;
 	};
+
+	// The uniqued objects that don't belong to a context, built once and shared by every context created from it.
+	// populate is called with the context of the prelude, and the metadata kinds, attributes and MDStrings it creates
+	// there are the ones shared. Nothing is changed after construction, so contexts on different threads can use the
+	// same prelude.
+	class LLVMContextPrelude : boost::noncopyable
+	{
+	public:
+		explicit LLVMContextPrelude(std::function<void(LLVMContext& context)> const & populate);
+
+		LLVMContextImpl const & Impl() const
+		{
+			return context_.Impl();
+		}
+
+	private:
+		LLVMContext context_;
+	};
 }
 
 #endif		// _DILITHIUM_LLVM_CONTEXT_HPP
@@ -40,6 +40,7 @@
 #include <Dilithium/CXX17/string_view.hpp>
 #include <Dilithium/DataLayout.hpp>
 #include <Dilithium/Function.hpp>
+#include <Dilithium/IList.hpp>
 #include <Dilithium/Metadata.hpp>
 #include <Dilithium/ValueSymbolTable.hpp>
 
@@ -61,7 +62,7 @@ namespace Dilithium
 	class LLVMModule : boost::noncopyable
 	{
 	public:
-		typedef std::list<std::unique_ptr<Function>> FunctionListType;
+		typedef IList<Function> FunctionListType;
 		typedef std::list<std::unique_ptr<NamedMDNode>> NamedMDListType;
 
 		typedef FunctionListType::iterator                           iterator;
@@ -96,6 +97,8 @@ namespace Dilithium
 		NamedMDNode* GetOrInsertNamedMetadata(std::string_view name);
 
 		void Materializer(std::shared_ptr<GVMaterializer> const & gvm);
+		// Parses the body of a lazily loaded function, if it's still pending.
+		void Materialize(GlobalValue* gv);
 		void MaterializeAllPermanently();
 
 		FunctionListType const & FunctionList() const
@@ -0,0 +1,89 @@
+/**
+ * @file MappedFile.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of Dilithium
+ * For the latest info, see https://github.com/gongminmin/Dilithium
+ *
+ * @section LICENSE
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Minmin Gong. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef _DILITHIUM_MAPPED_FILE_HPP
+#define _DILITHIUM_MAPPED_FILE_HPP
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <boost/core/noncopyable.hpp>
+
+namespace Dilithium
+{
+	// A whole file mapped read-only into memory. Pages come straight from the OS file cache, nothing is copied.
+	class MappedFile : boost::noncopyable
+	{
+	public:
+		enum class AccessPattern
+		{
+			Normal,
+			Sequential,	// Read ahead aggressively and drop pages behind the reader.
+			Random		// Don't read ahead.
+		};
+
+	public:
+		explicit MappedFile(std::string const & file_name, AccessPattern pattern = AccessPattern::Sequential);
+		~MappedFile();
+
+		uint8_t const * Data() const
+		{
+			return data_;
+		}
+		uint64_t Size() const
+		{
+			return size_;
+		}
+
+		// Hints that [offset, offset + length) is going to be read soon, so the OS can start paging it in.
+		void WillNeed(uint64_t offset, uint64_t length) const;
+
+	private:
+		void Close();
+
+	private:
+		uint8_t const * data_ = nullptr;
+		uint64_t size_ = 0;
+
+#ifdef _WIN32
+		void* file_handle_ = nullptr;
+		void* mapping_handle_ = nullptr;
+#endif
+	};
+}
+
+#endif		// _DILITHIUM_MAPPED_FILE_HPP
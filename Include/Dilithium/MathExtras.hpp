@@ -120,6 +120,83 @@ namespace Dilithium
 			}
 		};
 #endif
+#endif
+
+		template <typename T, std::size_t SizeOfT>
+		struct TrailingZerosCounter
+		{
+			static std::size_t Count(T val)
+			{
+				if (!val)
+				{
+					return std::numeric_limits<T>::digits;
+				}
+				else if (val & 0x1)
+				{
+					return 0;
+				}
+				else
+				{
+					std::size_t zero_bits = 0;
+					T shift = std::numeric_limits<T>::digits >> 1;
+					T mask = std::numeric_limits<T>::max() >> shift;
+					while (shift)
+					{
+						if ((val & mask) == 0)
+						{
+							val >>= shift;
+							zero_bits |= shift;
+						}
+						shift >>= 1;
+						mask >>= shift;
+					}
+					return zero_bits;
+				}
+			}
+		};
+
+#if defined(__GNUC__) || defined(_MSC_VER)
+		template <typename T>
+		struct TrailingZerosCounter<T, 4>
+		{
+			static std::size_t Count(T val)
+			{
+				if (val == 0)
+				{
+					return 32;
+				}
+
+#if __has_builtin(__builtin_ctz)
+				return __builtin_ctz(val);
+#elif defined(_MSC_VER)
+				unsigned long index;
+				_BitScanForward(&index, val);
+				return index;
+#endif
+			}
+		};
+
+#if !defined(_MSC_VER) || defined(_M_X64)
+		template <typename T>
+		struct TrailingZerosCounter<T, 8>
+		{
+			static std::size_t Count(T val)
+			{
+				if (val == 0)
+				{
+					return 64;
+				}
+
+#if __has_builtin(__builtin_ctzll)
+				return __builtin_ctzll(val);
+#elif defined(_MSC_VER)
+				unsigned long index;
+				_BitScanForward64(&index, val);
+				return index;
+#endif
+			}
+		};
+#endif
 #endif
 
 		template <typename T, std::size_t SizeOfT>
@@ -165,6 +242,14 @@ namespace Dilithium
 		return Detail::LeadingZerosCounter<T, sizeof(T)>::Count(val);
 	}
 
+	template <typename T>
+	inline std::size_t CountTrailingZeros(T val)
+	{
+		static_assert(std::numeric_limits<T>::is_integer && !std::numeric_limits<T>::is_signed,
+			"Only unsigned integral types are allowed.");
+		return Detail::TrailingZerosCounter<T, sizeof(T)>::Count(val);
+	}
+
 	template <typename T>
 	inline uint32_t CountPopulation(T val)
 	{
@@ -70,6 +70,11 @@ namespace Dilithium
 		};
 
 	public:
+		// Metadata lives in the memory of its context.
+		static void* operator new(size_t size, LLVMContext& context);
+		static void operator delete(void* p, size_t size);
+		static void operator delete(void* p, LLVMContext& context);
+
 		uint32_t MetadataId() const
 		{
 			return subclass_id_;
@@ -293,23 +298,24 @@ namespace Dilithium
 		}
 	};
 
+	// The characters are stored right behind the object, in the same allocation from the context.
 	class MDString : boost::noncopyable, public Metadata
 	{
-		MDString& operator=(MDString&&) = delete;
+		friend struct MDStringDeleter;
 
 	public:
 		typedef std::string_view::iterator iterator;
 
 	public:
-		MDString();
-		MDString(MDString&& rhs);
-
 		static MDString* Get(LLVMContext& context, std::string_view str);
 
-		std::string_view String() const;
+		std::string_view String() const
+		{
+			return std::string_view(reinterpret_cast<char const *>(this + 1), length_);
+		}
 		size_t Size() const
 		{
-			return string_.size();
+			return length_;
 		}
 
 		iterator begin() const
@@ -327,9 +333,12 @@ namespace Dilithium
 		}
 
 	private:
-		std::string string_;
-		uint64_t string_hash_;
-		// DILITHIUM_NOT_IMPLEMENTED
+		explicit MDString(std::string_view str);
+
+		static void Destroy(MDString* mds);
+
+	private:
+		uint32_t length_;
 	};
 
 	class MDOperand : boost::noncopyable
@@ -44,11 +44,11 @@ namespace Dilithium
 	{
 		static Use* OpBegin(SubClass* u)
 		{
-			return static_cast<User*>(u)->OperandList();
+			return reinterpret_cast<Use*>(static_cast<User*>(u)) - ARITY;
 		}
 		static Use* OpEnd(SubClass* u)
 		{
-			return static_cast<User*>(u)->OperandList() + ARITY;
+			return reinterpret_cast<Use*>(static_cast<User*>(u));
 		}
 		static uint32_t NumOperands(User const * u)
 		{
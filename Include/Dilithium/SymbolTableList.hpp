@@ -65,7 +65,7 @@ namespace Dilithium
 				auto symbol_tab = parent->GetValueSymbolTable();
 				if (symbol_tab)
 				{
-					symbol_tab->RemoveValueName(ptr->NameHash());
+					symbol_tab->RemoveValueName(ptr);
 				}
 			}
 			ptr->Parent(nullptr);
@@ -0,0 +1,80 @@
+/**
+ * @file ThreadGroup.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of Dilithium
+ * For the latest info, see https://github.com/gongminmin/Dilithium
+ *
+ * @section LICENSE
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Minmin Gong. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _DILITHIUM_THREAD_GROUP_HPP
+#define _DILITHIUM_THREAD_GROUP_HPP
+
+#pragma once
+
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <boost/core/noncopyable.hpp>
+
+namespace Dilithium
+{
+	// Worker threads that are joined when the group goes out of scope, so an exception can't leave one joinable.
+	class ThreadGroup : boost::noncopyable
+	{
+	public:
+		~ThreadGroup()
+		{
+			for (auto& thread : threads_)
+			{
+				thread.join();
+			}
+		}
+
+		// False if no more threads can be started. The work is then left to the threads already there.
+		template <typename Func>
+		bool Spawn(Func const & func)
+		{
+			try
+			{
+				threads_.emplace_back(func);
+				return true;
+			}
+			catch (std::system_error&)
+			{
+				return false;
+			}
+		}
+
+	private:
+		std::vector<std::thread> threads_;
+	};
+}
+
+#endif		// _DILITHIUM_THREAD_GROUP_HPP
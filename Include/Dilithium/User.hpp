@@ -49,6 +49,8 @@ namespace Dilithium
 	template <typename T>
 	struct OperandTraits;
 
+	// The operands of a user are allocated along with it, right in front of the object, as LLVM does. Users that need a
+	// growing number of operands hang them off instead, in a separate array.
 	class User : public Value
 	{
 	public:
@@ -57,12 +59,19 @@ namespace Dilithium
 		typedef boost::iterator_range<op_iterator> op_range;
 		typedef boost::iterator_range<const_op_iterator> const_op_range;
 
+		// As num_uses, allocates room for a pointer to hung off operands instead of the operands themselves.
+		static uint32_t constexpr HUNG_OFF_USES = ~0U;
+
 	public:
 		~User() override;
 
+		static void* operator new(size_t size, LLVMContext& context, uint32_t num_uses);
+		static void operator delete(void* p, size_t size);
+		static void operator delete(void* p, LLVMContext& context, uint32_t num_uses);
+
 		Use* OperandList()
 		{
-			return num_user_operands_ > 0 ? operands_.data() : nullptr;
+			return has_hung_off_uses_ ? this->HungOffOperands() : reinterpret_cast<Use*>(this) - num_user_operands_;
 		}
 		Use const * OperandList() const
 		{
@@ -115,8 +124,14 @@ namespace Dilithium
 		void DropAllReferences();
 
 	protected:
+		// num_uses has to be the one the user was allocated with.
 		User(Type* ty, uint32_t vty, uint32_t num_ops, uint32_t num_uses);
 
+		// Hung off users allocate their operands in their constructor, and reallocate them to get more. A phi node also
+		// gets room for a block pointer per operand, right after the operands.
+		void AllocHungoffUses(uint32_t num_uses, bool is_phi = false);
+		void GrowHungoffUses(uint32_t num_uses, bool is_phi = false);
+
 		template <int INDEX, typename U>
 		static Use& OpFrom(U const * that)
 		{
@@ -135,11 +150,17 @@ namespace Dilithium
 			return this->OpFrom<INDEX>(this);
 		}
 
-	protected:
-		std::vector<Use> operands_;
-		std::vector<BasicBlock*> phi_bbs_;
-		User* user_;
-		bool ref_;
+	private:
+		Use*& HungOffOperands()
+		{
+			return *(reinterpret_cast<Use**>(this) - 1);
+		}
+
+		static void ZapUses(Use* beg, Use* end);
+
+	private:
+		// The number of operands in front of the user, or in the hung off array.
+		uint32_t num_allocated_uses_;
 
 		// DILITHIUM_NOT_IMPLEMENTED
 	};
@@ -54,11 +54,40 @@ namespace Dilithium
 	class ModuleSlotTracker;
 	class Type;
 	class User;
+	class ValueSymbolTable;
+
+	// The name of a value. It lives in the memory of the context, with the characters right behind it.
+	class ValueName : boost::noncopyable
+	{
+	public:
+		static ValueName* Create(LLVMContext& context, std::string_view str, uint64_t hash);
+		static void Destroy(ValueName* name);
+
+		// The hash every name is stored and looked up with
+		static uint64_t HashValue(std::string_view str);
+
+		std::string_view Str() const
+		{
+			return std::string_view(reinterpret_cast<char const *>(this + 1), length_);
+		}
+		uint64_t Hash() const
+		{
+			return hash_;
+		}
+
+	private:
+		ValueName(std::string_view str, uint64_t hash);
+
+	private:
+		uint64_t hash_;
+		uint32_t length_;
+	};
 
 	class Value : boost::noncopyable
 	{
 		friend class ValueAsMetadata;
 		friend class ValueHandleBase;
+		friend class ValueSymbolTable;
 
 	public:
 		static uint32_t constexpr MAX_ALIGNMENT_EXPONENT = 29;
@@ -198,6 +227,11 @@ namespace Dilithium
 	public:
 		virtual ~Value();
 
+		// Values live in the memory of their context.
+		static void* operator new(size_t size, LLVMContext& context);
+		static void operator delete(void* p, size_t size);
+		static void operator delete(void* p, LLVMContext& context);
+
 		void Print(std::ostream& os) const;
 		void Print(std::ostream& os, ModuleSlotTracker& mst) const;
 
@@ -213,14 +247,17 @@ namespace Dilithium
 
 		bool HasName() const
 		{
-			return !name_.empty();
+			return name_ != nullptr;
 		}
 		uint64_t NameHash() const
 		{
-			return name_hash_;
+			return name_ ? name_->Hash() : 0;
 		}
 
-		std::string_view Name() const;
+		std::string_view Name() const
+		{
+			return name_ ? name_->Str() : std::string_view();
+		}
 		void Name(std::string_view name);
 
 		void ReplaceAllUsesWith(Value* val);
@@ -346,12 +383,12 @@ namespace Dilithium
 		static void MergeUseListsImpl(Use* l, Use* r, Use** next, std::function<bool(Use const & lhs, Use const & rhs)> cmp);
 
 	protected:
-		static uint32_t constexpr NUM_USER_OPERANDS_BITS = 31;
+		static uint32_t constexpr NUM_USER_OPERANDS_BITS = 30;
 		uint32_t num_user_operands_ : NUM_USER_OPERANDS_BITS;
 		bool is_used_by_md_ : 1;
+		bool has_hung_off_uses_ : 1;
 
-		std::string name_;
-		uint64_t name_hash_;
+		ValueName* name_;
 
 	private:
 		Type* type_;
@@ -38,15 +38,19 @@
 #pragma once
 
 #include <Dilithium/CXX17/string_view.hpp>
+#include <Dilithium/SmallString.hpp>
 #include <Dilithium/Value.hpp>
 
-#include <unordered_map>
+#include <iterator>
+#include <vector>
 
 #include <boost/core/noncopyable.hpp>
 
 namespace Dilithium
 {
-	class ValueSymbolTable
+	// Maps the names in a function or module to their values. It's an open addressing table keyed on the name strings.
+	// The hash of each name is kept in the table, so a probe only looks at a value when the hashes match.
+	class ValueSymbolTable : boost::noncopyable
 	{
 		friend class Value;
 		friend class BasicBlock;
@@ -56,51 +60,114 @@ namespace Dilithium
 		template <typename NodeType>
 		friend void RemoveFromSymbolTableList(NodeType*);
 
+		struct Bucket
+		{
+			uint64_t hash;
+			Value* val;
+		};
+
 	public:
-		typedef std::unordered_map<uint64_t, Value*> ValueMap;
-		typedef ValueMap::iterator iterator;
-		typedef ValueMap::const_iterator const_iterator;
+		class const_iterator
+		{
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef Value* value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef Value* const * pointer;
+			typedef Value* const & reference;
+
+		public:
+			const_iterator(Bucket const * bucket, Bucket const * end)
+				: bucket_(bucket), end_(end)
+			{
+				this->SkipEmpty();
+			}
+
+			reference operator*() const
+			{
+				return bucket_->val;
+			}
+
+			const_iterator& operator++()
+			{
+				++ bucket_;
+				this->SkipEmpty();
+				return *this;
+			}
+			const_iterator operator++(int)
+			{
+				const_iterator tmp = *this;
+				++ *this;
+				return tmp;
+			}
+
+			friend bool operator==(const_iterator const & lhs, const_iterator const & rhs)
+			{
+				return lhs.bucket_ == rhs.bucket_;
+			}
+			friend bool operator!=(const_iterator const & lhs, const_iterator const & rhs)
+			{
+				return lhs.bucket_ != rhs.bucket_;
+			}
+
+		private:
+			void SkipEmpty()
+			{
+				while ((bucket_ != end_) && !bucket_->val)
+				{
+					++ bucket_;
+				}
+			}
+
+		private:
+			Bucket const * bucket_;
+			Bucket const * end_;
+		};
+		typedef const_iterator iterator;
 
 	public:
 		ValueSymbolTable()
-			: vmap_(0), last_unique_(0)
+			: num_entries_(0), last_unique_(0)
 		{
 		}
 		~ValueSymbolTable();
 
 		bool empty() const
 		{
-			return vmap_.empty();
+			return num_entries_ == 0;
 		}
 		size_t size() const
 		{
-			return vmap_.size();
+			return num_entries_;
 		}
 
-		iterator begin()
-		{
-			return vmap_.begin();
-		}
 		const_iterator begin() const
 		{
-			return vmap_.begin();
-		}
-		iterator end()
-		{
-			return vmap_.end();
+			return const_iterator(buckets_.data(), buckets_.data() + buckets_.size());
 		}
 		const_iterator end() const
 		{
-			return vmap_.end();
+			return const_iterator(buckets_.data() + buckets_.size(), buckets_.data() + buckets_.size());
 		}
 
+		Value* Lookup(std::string_view name) const;
+
 	private:
 		void ReinsertValue(Value* val);
-		std::string CreateValueName(std::string_view name, Value* val);
-		void RemoveValueName(uint64_t name_hash);
+		ValueName* CreateValueName(std::string_view name, Value* val);
+		void RemoveValueName(Value* val);
+
+		// Appends a number, and a '.' before it if with_dot, to name until it's not in the table.
+		uint64_t MakeUniqueName(SmallString<256>& name, bool with_dot);
+
+		static size_t constexpr NOT_FOUND = ~static_cast<size_t>(0);
+		size_t FindBucket(std::string_view name, uint64_t hash) const;
+		void InsertBucket(Value* val, uint64_t hash);
+		void Grow();
 
 	private:
-		ValueMap vmap_;
+		std::vector<Bucket> buckets_;
+		size_t num_entries_;
 		mutable uint32_t last_unique_;
 	};
 }
@@ -37,11 +37,19 @@
 
 #pragma once
 
+#include <Dilithium/ArrayRef.hpp>
+#include <Dilithium/BitcodeReader.hpp>
 #include <Dilithium/Util.hpp>
 #include <Dilithium/dxc/HLSL/DxilConstants.hpp>
 
+#include <memory>
+#include <string>
+
 namespace Dilithium
 {
+	class LLVMModule;
+	class MappedFile;
+
 #pragma pack(push, 1)
 	size_t constexpr DxilContainerHashSize = 16;
 	uint16_t constexpr DxilContainerVersionMajor = 1;  // Current major version
@@ -250,6 +258,100 @@ namespace Dilithium
 	{
 		return static_cast<ShaderKind>((program_version & 0xFFFF0000U) >> 16);
 	}
+
+	// A container in memory, validated as a whole on construction. The first part of each kind is then found in constant
+	// time, and every part handed out is known to lie within the container. The memory has to outlive the view.
+	class DxilContainerView
+	{
+	public:
+		DxilContainerView(void const * data, size_t length);
+
+		// False if the data isn't a container, or isn't a valid one. Nothing else is available then.
+		bool Valid() const
+		{
+			return header_ != nullptr;
+		}
+
+		DxilContainerHeader const * Header() const
+		{
+			return header_;
+		}
+		uint32_t PartCount() const
+		{
+			return header_ ? header_->PartCount : 0;
+		}
+		DxilPartHeader const * Part(uint32_t index) const;
+
+		// The first part of kind four_cc, or null if there is none.
+		DxilPartHeader const * FindPart(uint32_t four_cc) const;
+		// The data of the first part of kind four_cc, empty if there is none.
+		ArrayRef<uint8_t> PartData(uint32_t four_cc) const;
+
+		// These are null if the part is missing, or too small for what it holds.
+		DxilShaderFeatureInfo const * FeatureInfo() const;
+		DxilProgramSignature const * InputSignature() const;
+		DxilProgramSignature const * OutputSignature() const;
+		DxilProgramSignature const * PatchConstantSignature() const;
+		// The program of the container, the debug one if there is one. Null if there is no valid program.
+		DxilProgramHeader const * Program() const;
+
+	private:
+		template <typename T>
+		T const * PartAs(uint32_t four_cc) const;
+
+		// The slot of a known part kind in first_parts_, or NUM_KNOWN_PARTS for the others.
+		static uint32_t KnownPartIndex(uint32_t four_cc);
+
+	private:
+		static uint32_t constexpr NUM_KNOWN_PARTS = 11;
+
+		DxilContainerHeader const * header_ = nullptr;
+		DxilPartHeader const * first_parts_[NUM_KNOWN_PARTS] = {};
+	};
+
+	// A shader file mapped read-only, with its container and program located once. The file can be a container, a bare
+	// program, or bare bitcode.
+	class DxilContainerFileView
+	{
+	public:
+		typedef BitcodeLoadMode LoadMode;
+
+	public:
+		explicit DxilContainerFileView(std::string const & file_name);
+
+		std::shared_ptr<MappedFile> const & File() const
+		{
+			return file_;
+		}
+		uint8_t const * Data() const;
+		uint32_t Size() const;
+
+		// Null if the file isn't a valid container.
+		DxilContainerHeader const * Container() const
+		{
+			return container_.Header();
+		}
+		// The container of the file, validated once when the file was opened. Not Valid() if there is none.
+		DxilContainerView const & ContainerView() const
+		{
+			return container_;
+		}
+		// The program of a container, the debug one if there is one. Or the file itself if it's a bare program. Null
+		// if there is no valid program.
+		DxilProgramHeader const * Program() const
+		{
+			return program_;
+		}
+
+		// Reads the bitcode of the program, or of the whole file if it's bare bitcode, straight from the mapping. The
+		// module keeps the file mapped as long as it needs it.
+		std::unique_ptr<LLVMModule> LoadModule(std::string const & name, LoadMode mode = LoadMode::Full) const;
+
+	private:
+		std::shared_ptr<MappedFile> file_;
+		DxilContainerView container_;
+		DxilProgramHeader const * program_ = nullptr;
+	};
 }
 
 #endif		// _DILITHIUM_DXIL_CONTAINER_HPP
@@ -0,0 +1,135 @@
+/**
+ * @file DxilContainerReflection.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of Dilithium
+ * For the latest info, see https://github.com/gongminmin/Dilithium
+ *
+ * @section LICENSE
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Minmin Gong. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef _DILITHIUM_DXIL_CONTAINER_REFLECTION_HPP
+#define _DILITHIUM_DXIL_CONTAINER_REFLECTION_HPP
+
+#pragma once
+
+#include <Dilithium/ArrayRef.hpp>
+#include <Dilithium/CXX17/string_view.hpp>
+#include <Dilithium/dxc/HLSL/DxilConstants.hpp>
+#include <Dilithium/dxc/HLSL/DxilContainer.hpp>
+#include <Dilithium/dxc/HLSL/DxilPipelineStateValidation.hpp>
+
+#include <boost/assert.hpp>
+
+namespace Dilithium
+{
+	// A signature part, ISG1, OSG1 or PSG1, read in place. The elements are the packed structs of the part, and their
+	// semantic names point into it.
+	class DxilSignatureView
+	{
+	public:
+		typedef DxilProgramSignatureElement const * iterator;
+
+	public:
+		DxilSignatureView() = default;
+		// An invalid part gives an invalid, empty view.
+		explicit DxilSignatureView(ArrayRef<uint8_t> part);
+
+		bool Valid() const
+		{
+			return signature_ != nullptr;
+		}
+
+		uint32_t size() const
+		{
+			return signature_ ? signature_->ParamCount : 0;
+		}
+		bool empty() const
+		{
+			return this->size() == 0;
+		}
+		iterator begin() const
+		{
+			return elements_;
+		}
+		iterator end() const
+		{
+			return elements_ + this->size();
+		}
+		DxilProgramSignatureElement const & operator[](uint32_t index) const
+		{
+			BOOST_ASSERT(index < this->size());
+			return elements_[index];
+		}
+
+		// Empty if the name doesn't lie in the part. Cut at the end of the part if it isn't terminated there.
+		std::string_view SemanticName(DxilProgramSignatureElement const & element) const;
+
+		// True if any element is on a stream other than 0.
+		bool HasStreams() const;
+
+	private:
+		ArrayRef<uint8_t> part_;
+		DxilProgramSignature const * signature_ = nullptr;
+		DxilProgramSignatureElement const * elements_ = nullptr;
+	};
+
+	// What the parts of a container besides the program say about the shader: its stage, the features it needs, its
+	// signatures and its pipeline runtime info. Nothing here decodes bitcode or needs an LLVMContext.
+	class DxilContainerReflection
+	{
+	public:
+		// The view is copied, but the data of the container has to outlive the reflection.
+		explicit DxilContainerReflection(DxilContainerView const & container);
+
+		// From the program header, Invalid if there is no valid program.
+		ShaderKind GetShaderKind() const;
+		uint32_t ShaderModelMajor() const;
+		uint32_t ShaderModelMinor() const;
+
+		// 0 without a feature info part.
+		uint64_t FeatureFlags() const;
+		bool HasFeature(DxilShaderFeatureInfoFlags flag) const
+		{
+			return (this->FeatureFlags() & flag) != 0;
+		}
+
+		DxilSignatureView InputSignature() const;
+		DxilSignatureView OutputSignature() const;
+		DxilSignatureView PatchConstantSignature() const;
+
+		// Null without a PSV0 part, or if its runtime info is smaller than PSVRuntimeInfo0.
+		PSVRuntimeInfo0 const * RuntimeInfo() const;
+
+	private:
+		DxilContainerView container_;
+		DxilProgramHeader const * program_;
+	};
+}
+
+#endif		// _DILITHIUM_DXIL_CONTAINER_REFLECTION_HPP
@@ -41,6 +41,7 @@
 
 namespace Dilithium
 {
+	class LLVMContextPrelude;
 	class LLVMModule;
 
 	class DxilCBuffer;
@@ -66,6 +67,35 @@ namespace Dilithium
 			DxilRootSignatureTag
 		};
 
+		enum GSState
+		{
+			DxilGSStateInputPrimitive = 0,
+			DxilGSStateMaxVertexCount,
+			DxilGSStateActiveStreamMask,
+			DxilGSStateOutputStreamTopology,
+			DxilGSStateGSInstanceCount,
+			DxilGSStateNumFields
+		};
+
+		enum DSState
+		{
+			DxilDSStateTessellatorDomain = 0,
+			DxilDSStateInputControlPointCount,
+			DxilDSStateNumFields
+		};
+
+		enum HSState
+		{
+			DxilHSStatePatchConstantFunction = 0,
+			DxilHSStateInputControlPointCount,
+			DxilHSStateOutputControlPointCount,
+			DxilHSStateTessellatorDomain,
+			DxilHSStateTessellatorPartitioning,
+			DxilHSStateTessellatorOutputPrimitive,
+			DxilHSStateMaxTessellationFactor,
+			DxilHSStateNumFields
+		};
+
 		enum Resources
 		{
 			DxilResourceSRVs = 0,
@@ -121,6 +151,12 @@ namespace Dilithium
 			DxilSamplerNumFields = 8
 		};
 
+		enum ResourceExtendedProperties
+		{
+			DxilTypedBufferElementTypeTag = 0,
+			DxilStructuredBufferElementStrideTag
+		};
+
 		enum SignatureElementExtendedProperties
 		{
 			DxilSignatureElementOutputStreamTag = 0,
@@ -189,10 +225,15 @@ namespace Dilithium
 		static int8_t ConstMDToInt8(MDOperand const & operand);
 		static uint8_t ConstMDToUInt8(MDOperand const & operand);
 		static bool ConstMDToBool(MDOperand const & operand);
+		static float ConstMDToFloat(MDOperand const & operand);
 		static std::string StringMDToString(MDOperand const & operand);
 		static Value* ValueMDToValue(MDOperand const & operand);
 		void ConstMDTupleToUInt32Vector(MDTuple* tuple_md, std::vector<uint32_t>& vec);
 
+		// Metadata kinds, dx.op function attributes and metadata strings found in almost every DXIL module. Built on
+		// first call, and shared by all the modules loaded with it.
+		static std::shared_ptr<LLVMContextPrelude const> const & ContextPrelude();
+
 	private:
 		LLVMContext& context_;
 		LLVMModule* module_;
@@ -210,6 +251,10 @@ namespace Dilithium
 		void LoadCBufferProperties(MDOperand const & operand, DxilCBuffer& cb) override;
 		void LoadSamplerProperties(MDOperand const & operand, DxilSampler& sampler) override;
 		void LoadSignatureElementProperties(MDOperand const & operand, DxilSignatureElement& se) override;
+
+	private:
+		// The SRV and UAV properties: the component type of typed buffers and the stride of structured buffers.
+		static void LoadResourceProperties(MDOperand const & operand, DxilResource& res);
 	};
 }
 
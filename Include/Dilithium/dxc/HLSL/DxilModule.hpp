@@ -41,6 +41,8 @@
 #include <Dilithium/dxc/HLSL/DxilSignature.hpp>
 #include <Dilithium/dxc/HLSL/DxilRootSignature.hpp>
 
+#include <boost/assert.hpp>
+
 namespace Dilithium
 {
 	class LLVMModule;
@@ -183,6 +185,23 @@ namespace Dilithium
 			uint32_t align1_;			// align to 64 bit.
 		};
 
+		// The sections of the metadata. LoadDxilMetadata only reads the version, the shader model and the entry point.
+		// Each section is loaded the first time one of its accessors is called. That happens through const accessors
+		// too, so they aren't thread safe until the sections are loaded. Call LoadSections(MS_All) before sharing a
+		// module between threads.
+		enum MetadataSection : uint32_t
+		{
+			MS_Signatures = 1UL << 0,
+			MS_SRVs = 1UL << 1,
+			MS_UAVs = 1UL << 2,
+			MS_CBuffers = 1UL << 3,
+			MS_Samplers = 1UL << 4,
+			MS_ShaderProperties = 1UL << 5,	// Shader flags, per-stage state and the root signature
+
+			MS_Resources = MS_SRVs | MS_UAVs | MS_CBuffers | MS_Samplers,
+			MS_All = MS_Signatures | MS_Resources | MS_ShaderProperties
+		};
+
 	public:
 		explicit DxilModule(LLVMModule* mod);
 		~DxilModule();
@@ -194,8 +213,148 @@ namespace Dilithium
 
 		void LoadDxilMetadata();
 
+		// Loads the given sections that aren't loaded yet. A section that fails to load is left empty and is tried
+		// again on the next access. Sections being loaded are skipped, so the loaders can call the Add* methods.
+		void LoadSections(uint32_t sections) const
+		{
+			uint32_t const missing = sections & ~(loaded_sections_ | loading_sections_);
+			if (missing != 0)
+			{
+				const_cast<DxilModule*>(this)->LoadMissingSections(missing);
+			}
+		}
+		// The sections loaded so far. A module that wasn't loaded from metadata has all of them.
+		uint32_t LoadedSections() const
+		{
+			return loaded_sections_;
+		}
+
+		DxilSignature const & GetInputSignature() const
+		{
+			this->LoadSections(MS_Signatures);
+			return *input_signature_;
+		}
+		DxilSignature const & GetOutputSignature() const
+		{
+			this->LoadSections(MS_Signatures);
+			return *output_signature_;
+		}
+		DxilSignature const & GetPatchConstantSignature() const
+		{
+			this->LoadSections(MS_Signatures);
+			return *patch_constant_signature_;
+		}
+
+		std::vector<std::unique_ptr<DxilResource>> const & GetSRVs() const
+		{
+			this->LoadSections(MS_SRVs);
+			return srvs_;
+		}
+		std::vector<std::unique_ptr<DxilResource>> const & GetUAVs() const
+		{
+			this->LoadSections(MS_UAVs);
+			return uavs_;
+		}
+		std::vector<std::unique_ptr<DxilCBuffer>> const & GetCBuffers() const
+		{
+			this->LoadSections(MS_CBuffers);
+			return cbuffers_;
+		}
+		std::vector<std::unique_ptr<DxilSampler>> const & GetSamplers() const
+		{
+			this->LoadSections(MS_Samplers);
+			return samplers_;
+		}
+
+		DxilShaderModel const * GetShaderModel() const
+		{
+			return sm_;
+		}
+		ShaderFlags const & GetShaderFlags() const
+		{
+			this->LoadSections(MS_ShaderProperties);
+			return shader_flags_;
+		}
+		// Null before the metadata is loaded.
+		DxilRootSignatureHandle const * GetRootSignature() const
+		{
+			this->LoadSections(MS_ShaderProperties);
+			return root_signature_.get();
+		}
+
+		// Compute shader
+		uint32_t GetNumThreads(uint32_t index) const
+		{
+			BOOST_ASSERT(index < 3);
+			this->LoadSections(MS_ShaderProperties);
+			return num_threads_[index];
+		}
+
+		// Geometry shader
+		InputPrimitive GetInputPrimitive() const
+		{
+			this->LoadSections(MS_ShaderProperties);
+			return input_primitive_;
+		}
+		uint32_t GetMaxVertexCount() const
+		{
+			this->LoadSections(MS_ShaderProperties);
+			return max_vertex_count_;
+		}
+		uint32_t GetActiveStreamMask() const
+		{
+			this->LoadSections(MS_ShaderProperties);
+			return active_stream_mask_;
+		}
+		PrimitiveTopology GetStreamPrimitiveTopology() const
+		{
+			this->LoadSections(MS_ShaderProperties);
+			return stream_primitive_topology_;
+		}
+		uint32_t GetGSInstanceCount() const
+		{
+			this->LoadSections(MS_ShaderProperties);
+			return num_gs_instances_;
+		}
+
+		// Hull and Domain shaders
+		TessellatorDomain GetTessellatorDomain() const
+		{
+			this->LoadSections(MS_ShaderProperties);
+			return tessellator_domain_;
+		}
+		uint32_t GetInputControlPointCount() const
+		{
+			this->LoadSections(MS_ShaderProperties);
+			return input_control_point_count_;
+		}
+
+		// Hull shader
+		uint32_t GetOutputControlPointCount() const
+		{
+			this->LoadSections(MS_ShaderProperties);
+			return output_control_point_count_;
+		}
+		TessellatorPartitioning GetTessellatorPartitioning() const
+		{
+			this->LoadSections(MS_ShaderProperties);
+			return tessellator_partitioning_;
+		}
+		TessellatorOutputPrimitive GetTessellatorOutputPrimitive() const
+		{
+			this->LoadSections(MS_ShaderProperties);
+			return tessellator_output_primitive_;
+		}
+		float GetMaxTessellationFactor() const
+		{
+			this->LoadSections(MS_ShaderProperties);
+			return max_tessellation_factor_;
+		}
+
 	private:
-		void LoadDxilResources(MDOperand const & operand);
+		void LoadMissingSections(uint32_t sections);
+		void ResetSections(uint32_t sections);
+		void LoadDxilResources(MDOperand const & operand, uint32_t sections);
 		void LoadDxilShaderProperties(MDOperand const & operand);
 
 		template <typename T>
@@ -207,13 +366,19 @@ namespace Dilithium
 		Function* entry_func_;
 		Function* patch_constant_func_;
 		std::string entry_name_;
+
+		// The entry point's operands, kept to load the sections from. Null for the ones it doesn't have.
+		MDOperand const * signatures_md_;
+		MDOperand const * resources_md_;
+		MDOperand const * properties_md_;
+		uint32_t loaded_sections_;
+		uint32_t loading_sections_;
+
 		std::unique_ptr<DxilMDHelper> md_helper_;
 		DxilShaderModel const * sm_;
 		uint32_t dxil_major_;
 		uint32_t dxil_minor_;
 
-		std::unique_ptr<DxilTypeSystem> type_system_;
-
 		std::unique_ptr<DxilSignature> input_signature_;
 		std::unique_ptr<DxilSignature> output_signature_;
 		std::unique_ptr<DxilSignature> patch_constant_signature_;
@@ -0,0 +1,186 @@
+/**
+ * @file DxilReflectionCache.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of Dilithium
+ * For the latest info, see https://github.com/gongminmin/Dilithium
+ *
+ * @section LICENSE
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Minmin Gong. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _DILITHIUM_DXIL_REFLECTION_CACHE_HPP
+#define _DILITHIUM_DXIL_REFLECTION_CACHE_HPP
+
+#pragma once
+
+#include <Dilithium/ArrayRef.hpp>
+#include <Dilithium/CXX17/string_view.hpp>
+#include <Dilithium/dxc/HLSL/DxilContainer.hpp>
+#include <Dilithium/dxc/HLSL/DxilContainerReflection.hpp>
+
+#include <memory>
+#include <string>
+
+#include <boost/endian/arithmetic.hpp>
+
+namespace Dilithium
+{
+	class DxilModule;
+
+#pragma pack(push, 1)
+	uint32_t constexpr DxilReflectionRecordFourCC = MakeFourCC<'D', 'R', 'F', 'L'>::value;
+	uint32_t constexpr DxilReflectionRecordVersion = 1;
+
+	struct DxilReflectionBlob
+	{
+		boost::endian::little_uint32_t Offset;	// From the start of the record
+		boost::endian::little_uint32_t Size;
+	};
+
+	// A record is this header followed by its blobs. Offsets are from the start of the header, so a mapped record is
+	// read in place. Multi-byte fields are little endian on every host, and are converted when they are accessed.
+	struct DxilReflectionRecordHeader
+	{
+		boost::endian::little_uint32_t HeaderFourCC;
+		boost::endian::little_uint32_t Version;
+		boost::endian::little_uint32_t SizeInBytes;	// Of the whole record
+		DxilContainerHash Hash;						// Of the container the record was made from
+		uint8_t ShaderKind;
+		uint8_t ShaderModelMajor;
+		uint8_t ShaderModelMinor;
+		uint8_t Pad;
+		boost::endian::little_uint64_t ShaderFlags;	// DxilModule::ShaderFlags, raw
+
+		// Compute shader
+		boost::endian::little_uint32_t NumThreads[3];
+
+		// Geometry shader
+		boost::endian::little_uint32_t InputPrimitive;
+		boost::endian::little_uint32_t MaxVertexCount;
+		boost::endian::little_uint32_t ActiveStreamMask;
+		boost::endian::little_uint32_t StreamPrimitiveTopology;
+		boost::endian::little_uint32_t GSInstanceCount;
+
+		// Hull and Domain shaders
+		boost::endian::little_uint32_t TessellatorDomain;
+		boost::endian::little_uint32_t InputControlPointCount;
+		boost::endian::little_uint32_t OutputControlPointCount;
+		boost::endian::little_uint32_t TessellatorPartitioning;
+		boost::endian::little_uint32_t TessellatorOutputPrimitive;
+		boost::endian::little_float32_t MaxTessellationFactor;
+
+		DxilReflectionBlob InputSignature;			// Copies of the ISG1, OSG1 and PSG1 parts
+		DxilReflectionBlob OutputSignature;
+		DxilReflectionBlob PatchConstantSignature;
+		DxilReflectionBlob Resources;				// DxilReflectionResource[]
+		DxilReflectionBlob RootSignature;			// Serialized
+	};
+
+	struct DxilReflectionResource
+	{
+		uint8_t Class;		// ResourceClass
+		uint8_t Kind;		// ResourceKind
+		boost::endian::little_uint16_t Pad;
+		boost::endian::little_uint32_t ID;
+		boost::endian::little_uint32_t Space;
+		boost::endian::little_uint32_t LowerBound;
+		boost::endian::little_uint32_t RangeSize;
+		boost::endian::little_uint32_t Name;	// Offset to a null-terminated name, from the start of the record
+	};
+#pragma pack(pop)
+
+	// The reflection of one shader, read in place from a cache file or from the buffer it was laid out in. Copies
+	// share the storage.
+	class DxilReflectionRecord
+	{
+	public:
+		DxilReflectionRecord() = default;
+		// Lays out the record of a container and of the module loaded from its program.
+		DxilReflectionRecord(DxilContainerView const & container, DxilModule const & module);
+		// A file that isn't a valid record gives an invalid record.
+		explicit DxilReflectionRecord(std::shared_ptr<MappedFile> const & file);
+
+		bool Valid() const
+		{
+			return header_ != nullptr;
+		}
+
+		DxilReflectionRecordHeader const * Header() const
+		{
+			return header_;
+		}
+		ArrayRef<uint8_t> Data() const
+		{
+			return data_;
+		}
+
+		DxilSignatureView InputSignature() const;
+		DxilSignatureView OutputSignature() const;
+		DxilSignatureView PatchConstantSignature() const;
+
+		ArrayRef<DxilReflectionResource> Resources() const;
+		std::string_view ResourceName(DxilReflectionResource const & res) const;
+
+		ArrayRef<uint8_t> RootSignature() const;
+
+	private:
+		// Sets header_ if data_ holds a valid record.
+		void Validate();
+		ArrayRef<uint8_t> Blob(DxilReflectionBlob const & blob) const;
+
+	private:
+		std::shared_ptr<void const> storage_;
+		ArrayRef<uint8_t> data_;
+		DxilReflectionRecordHeader const * header_ = nullptr;
+	};
+
+	// Reflection records on disk, one file per container hash. Reopening an unchanged shader costs a lookup and a
+	// mapping instead of a bitcode decode. Files are written whole and then renamed into place, so processes sharing
+	// a directory never see a partial record.
+	class DxilReflectionCache
+	{
+	public:
+		// Creates dir if it doesn't exist.
+		explicit DxilReflectionCache(std::string const & dir);
+
+		// Invalid if there is no valid record for hash.
+		DxilReflectionRecord Find(DxilContainerHash const & hash) const;
+		void Store(DxilReflectionRecord const & record) const;
+
+		// The record of the container in file. On a miss, the module-level blocks of its program are parsed and the
+		// record is stored. Containers without a hash are never cached.
+		DxilReflectionRecord GetOrCreate(DxilContainerFileView const & file) const;
+
+	private:
+		std::string FileName(DxilContainerHash const & hash) const;
+
+	private:
+		std::string dir_;
+	};
+}
+
+#endif		// _DILITHIUM_DXIL_REFLECTION_CACHE_HPP
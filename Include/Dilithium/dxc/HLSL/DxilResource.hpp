@@ -37,6 +37,7 @@
 
 #pragma once
 
+#include <Dilithium/dxc/HLSL/DxilCompType.hpp>
 #include <Dilithium/dxc/HLSL/DxilResourceBase.hpp>
 
 namespace Dilithium
@@ -46,6 +47,23 @@ namespace Dilithium
 	public:
 		DxilResource();
 
+		DxilCompType GetCompType() const
+		{
+			return comp_type_;
+		}
+		void SetCompType(DxilCompType const & comp_type)
+		{
+			comp_type_ = comp_type;
+		}
+		uint32_t GetElementStride() const
+		{
+			return element_stride_;
+		}
+		void SetElementStride(uint32_t element_stride)
+		{
+			element_stride_ = element_stride;
+		}
+
 		uint32_t GetSampleCount() const
 		{
 			return sample_count_;
@@ -93,7 +111,18 @@ namespace Dilithium
 			rov_ = rov;
 		}
 
+		bool IsStructuredBuffer() const
+		{
+			return this->GetKind() == ResourceKind::StructuredBuffer;
+		}
+		bool IsRawBuffer() const
+		{
+			return this->GetKind() == ResourceKind::RawBuffer;
+		}
+
 	private:
+		DxilCompType comp_type_;
+		uint32_t element_stride_;
 		uint32_t sample_count_;
 		bool globally_coherent_;
 		bool has_counter_;
@@ -54,15 +54,31 @@ namespace Dilithium
 			return class_;
 		}
 
+		ResourceKind GetKind() const
+		{
+			return kind_;
+		}
 		void SetKind(ResourceKind resource_kind);
+		uint32_t GetSpaceID() const
+		{
+			return space_id_;
+		}
 		void SetSpaceID(uint32_t space_id)
 		{
 			space_id_ = space_id;
 		}
+		uint32_t GetLowerBound() const
+		{
+			return lower_bound_;
+		}
 		void SetLowerBound(uint32_t lb)
 		{
 			lower_bound_ = lb;
 		}
+		uint32_t GetRangeSize() const
+		{
+			return range_size_;
+		}
 		void SetRangeSize(uint32_t range_size)
 		{
 			range_size_ = range_size;
@@ -71,6 +87,10 @@ namespace Dilithium
 		{
 			symbol_ = gv;
 		}
+		std::string const & GetGlobalName() const
+		{
+			return name_;
+		}
 		void SetGlobalName(std::string const & name)
 		{
 			name_ = name;
@@ -80,6 +100,10 @@ namespace Dilithium
 			handle_ = handle;
 		}
 
+		uint32_t GetID() const
+		{
+			return id_;
+		}
 		// TODO: check whether we can make this a protected method.
 		void SetID(uint32_t id)
 		{
@@ -0,0 +1,110 @@
+/**
+ * @file Arena.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of Dilithium
+ * For the latest info, see https://github.com/gongminmin/Dilithium
+ *
+ * @section LICENSE
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Minmin Gong. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <Dilithium/Arena.hpp>
+#include <Dilithium/Util.hpp>
+
+#include <new>
+
+namespace Dilithium
+{
+	Arena::Arena()
+	{
+	}
+
+	Arena::~Arena()
+	{
+		for (auto slab : slabs_)
+		{
+			::operator delete(slab);
+		}
+	}
+
+	void* Arena::Allocate(size_t size)
+	{
+		size = RoundUp(size == 0 ? 1 : size);
+		if (size <= MAX_RECYCLED_SIZE)
+		{
+			auto& free_list = free_lists_[size / ALIGNMENT - 1];
+			if (free_list)
+			{
+				auto block = free_list;
+				free_list = block->next;
+				return block;
+			}
+		}
+
+		if (size > static_cast<size_t>(end_ - curr_))
+		{
+			if (size > SLAB_SIZE / 4)
+			{
+				// Keeps the rest of the current slab for the small blocks that come next.
+				return this->NewSlab(size);
+			}
+
+			curr_ = this->NewSlab(SLAB_SIZE);
+			end_ = curr_ + SLAB_SIZE;
+		}
+
+		void* ret = curr_;
+		curr_ += size;
+		return ret;
+	}
+
+	void Arena::Deallocate(void* p, size_t size)
+	{
+		if ((p == nullptr) || released_)
+		{
+			return;
+		}
+
+		size = RoundUp(size == 0 ? 1 : size);
+		if (size <= MAX_RECYCLED_SIZE)
+		{
+			auto block = static_cast<FreeBlock*>(p);
+			auto& free_list = free_lists_[size / ALIGNMENT - 1];
+			block->next = free_list;
+			free_list = block;
+		}
+	}
+
+	uint8_t* Arena::NewSlab(size_t size)
+	{
+		slabs_.reserve(slabs_.size() + 1);
+		void* slab = ::operator new(size);
+		slabs_.push_back(slab);
+		num_bytes_reserved_ += size;
+		return static_cast<uint8_t*>(slab);
+	}
+}
@@ -298,20 +298,19 @@ namespace Dilithium
 			boost::container::small_vector<Attribute, 8> SortedAttrs(attrs.begin(), attrs.end());
 			std::sort(SortedAttrs.begin(), SortedAttrs.end());
 
-			size_t hash_val = 0;
-			for (auto iter = SortedAttrs.begin(), end_iter = SortedAttrs.end(); iter != end_iter; ++iter)
+			ArrayRef<Attribute> const key(SortedAttrs.data(), SortedAttrs.size());
+			size_t const hash_val = AttributeSetNodeKeyInfo::HashValue(key);
+			auto pa = context_impl.prelude ? context_impl.prelude->attrs_set_nodes.Find(key, hash_val) : nullptr;
+			if (!pa)
 			{
-				boost::hash_combine(hash_val, iter->RawPointer());
+				pa = context_impl.attrs_set_nodes.Find(key, hash_val);
 			}
-
-			auto iter = context_impl.attrs_set_nodes.find(hash_val);
-			if (iter == context_impl.attrs_set_nodes.end())
+			if (!pa)
 			{
-				auto pa = std::make_unique<AttributeSetNode>(SortedAttrs);
-				iter = context_impl.attrs_set_nodes.emplace(hash_val, std::move(pa)).first;
+				pa = context_impl.attrs_set_nodes.Insert(new AttributeSetNode(key), hash_val);
 			}
 
-			return iter->second.get();
+			return pa;
 		}
 	}
 
@@ -55,28 +55,28 @@ namespace Dilithium
 	Attribute Attribute::Get(LLVMContext& context, AttrKind kind, uint64_t val)
 	{
 		auto& context_impl = context.Impl();
-		size_t hash_val = boost::hash_value(kind);
-		if (val)
+
+		AttributeKeyInfo::KeyTy const key(kind, val);
+		size_t const hash_val = AttributeKeyInfo::HashValue(key);
+		AttributeImpl* pa = context_impl.prelude ? context_impl.prelude->attrs_set.Find(key, hash_val) : nullptr;
+		if (!pa)
 		{
-			boost::hash_combine(hash_val, val);
+			pa = context_impl.attrs_set.Find(key, hash_val);
 		}
-
-		auto iter = context_impl.attrs_set.find(hash_val);
-		if (iter == context_impl.attrs_set.end())
+		if (!pa)
 		{
-			std::unique_ptr<AttributeImpl> pa;
 			if (!val)
 			{
-				pa = std::make_unique<EnumAttributeImpl>(kind);
+				pa = new EnumAttributeImpl(kind);
 			}
 			else
 			{
-				pa = std::make_unique<IntAttributeImpl>(kind, val);
+				pa = new IntAttributeImpl(kind, val);
 			}
-			iter = context_impl.attrs_set.emplace(hash_val, std::move(pa)).first;
+			context_impl.attrs_set.Insert(pa, hash_val);
 		}
 
-		return Attribute(iter->second.get());
+		return Attribute(pa);
 	}
 
 	Attribute Attribute::Get(LLVMContext& context, std::string_view kind, std::string_view val)
@@ -359,21 +359,14 @@ namespace Dilithium
 	{
 		auto& context_impl = context.Impl();
 
-		size_t hash_val = 0;
-		for (auto iter = attrs.begin(), end_iter = attrs.end(); iter != end_iter; ++ iter)
-		{
-			boost::hash_combine(hash_val, iter->first);
-			boost::hash_combine(hash_val, iter->second);
-		}
-
-		auto iter = context_impl.attrs_lists.find(hash_val);
-		if (iter == context_impl.attrs_lists.end())
+		size_t const hash_val = AttributeSetImplKeyInfo::HashValue(attrs);
+		auto pa = context_impl.attrs_lists.Find(attrs, hash_val);
+		if (!pa)
 		{
-			auto pa = std::make_unique<AttributeSetImpl>(context, attrs);
-			iter = context_impl.attrs_lists.emplace(hash_val, std::move(pa)).first;
+			pa = context_impl.attrs_lists.Insert(new AttributeSetImpl(context, attrs), hash_val);
 		}
 
-		return AttributeSet(iter->second.get());
+		return AttributeSet(pa);
 	}
 
 	AttributeSet::iterator AttributeSet::Begin(uint32_t slot) const
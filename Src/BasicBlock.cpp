@@ -43,7 +43,7 @@ namespace Dilithium
 	BasicBlock::BasicBlock(LLVMContext& context, std::string_view name, Function* new_parent)
 		: Value(Type::LabelType(context), Value::BasicBlockVal), parent_(nullptr)
 	{
-		new_parent->BasicBlockList().push_back(std::unique_ptr<BasicBlock>(this));
+		new_parent->BasicBlockList().push_back(this);
 		AddToSymbolTableList(this, new_parent);
 
 		this->Name(name);
@@ -71,7 +71,7 @@ namespace Dilithium
 
 	BasicBlock* BasicBlock::Create(LLVMContext& context, std::string_view name, Function* parent)
 	{
-		return new BasicBlock(context, name, parent);
+		return new (context) BasicBlock(context, name, parent);
 	}
 
 	ValueSymbolTable* BasicBlock::GetValueSymbolTable()
@@ -91,7 +91,7 @@ namespace Dilithium
 	{
 		for (auto iter = begin(), end_iter = end(); iter != end_iter; ++ iter)
 		{
-			(*iter)->DropAllReferences();
+			iter->DropAllReferences();
 		}
 	}
 
@@ -115,9 +115,9 @@ namespace Dilithium
 			{
 				for (auto iter = inst_list_.begin(); iter != inst_list_.end(); ++ iter)
 				{
-					if ((*iter)->HasName())
+					if (iter->HasName())
 					{
-						old_st->RemoveValueName((*iter)->NameHash());
+						old_st->RemoveValueName(&*iter);
 					}
 				}
 			}
@@ -126,9 +126,9 @@ namespace Dilithium
 			{
 				for (auto iter = inst_list_.begin(); iter != inst_list_.end(); ++ iter)
 				{
-					if ((*iter)->HasName())
+					if (iter->HasName())
 					{
-						new_st->ReinsertValue(iter->get());
+						new_st->ReinsertValue(&*iter);
 					}
 				}
 			}
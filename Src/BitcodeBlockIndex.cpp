@@ -0,0 +1,318 @@
+/**
+ * @file BitcodeBlockIndex.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of Dilithium
+ * For the latest info, see https://github.com/gongminmin/Dilithium
+ *
+ * @section LICENSE
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Minmin Gong. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <Dilithium/Dilithium.hpp>
+#include <Dilithium/BitcodeBlockIndex.hpp>
+
+#include <Dilithium/BitstreamReader.hpp>
+#include <Dilithium/LLVMBitCodes.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#include <boost/endian/conversion.hpp>
+
+namespace
+{
+	using namespace Dilithium;
+
+	uint32_t constexpr INDEX_FOURCC = MakeFourCC<'D', 'B', 'B', 'I'>::value;
+	uint32_t constexpr INDEX_VERSION = 2;
+
+	struct IndexHeader
+	{
+		uint32_t four_cc;
+		uint32_t version;
+		uint32_t bitcode_length;
+		uint32_t num_blocks;
+		uint64_t bitcode_hash;
+	};
+
+	// block_id, parent, bit_offset, num_bits
+	size_t constexpr SERIALIZED_BLOCK_SIZE = 4 + 4 + 8 + 8;
+
+	// 64-bit FNV-1a over the little endian words of the bitstream, whose size is always a multiple of 4.
+	uint64_t HashBitcode(uint8_t const * bitcode, uint32_t bitcode_length)
+	{
+		uint64_t hash = 0xCBF29CE484222325ULL;
+		for (uint32_t i = 0; i + 4 <= bitcode_length; i += 4)
+		{
+			uint32_t word;
+			std::memcpy(&word, bitcode + i, sizeof(word));
+			hash ^= boost::endian::little_to_native(word);
+			hash *= 0x100000001B3ULL;
+		}
+		return hash;
+	}
+
+	template <typename T>
+	void Write(std::vector<uint8_t>& buff, T val)
+	{
+		val = boost::endian::native_to_little(val);
+		auto const * p = reinterpret_cast<uint8_t const *>(&val);
+		buff.insert(buff.end(), p, p + sizeof(val));
+	}
+
+	template <typename T>
+	T Read(uint8_t const *& p)
+	{
+		T val;
+		std::memcpy(&val, p, sizeof(val));
+		p += sizeof(val);
+		return boost::endian::little_to_native(val);
+	}
+
+	class BlockIndexBuilder
+	{
+	public:
+		BlockIndexBuilder(std::vector<BitcodeBlockIndex::Block>& blocks, bool index_function_blocks)
+			: blocks_(blocks), index_function_blocks_(index_function_blocks)
+		{
+		}
+
+		void Build(uint8_t const * beg, uint8_t const * end)
+		{
+			BitStreamReader reader(beg, end);
+			BitStreamCursor cursor(reader);
+			if ((cursor.Read(8) != 'B')
+				|| (cursor.Read(8) != 'C')
+				|| (cursor.Read(8) != 0xC0)
+				|| (cursor.Read(8) != 0xDE))
+			{
+				TERROR("Invalid bitcode signature");
+			}
+
+			while (!cursor.AtEndOfStream())
+			{
+				BitStreamEntry entry = cursor.Advance(BitStreamCursor::AF_DontAutoprocessAbbrevs);
+				if (entry.kind != BitStreamEntry::SubBlock)
+				{
+					TERROR("Malformed block");
+				}
+				this->IndexBlock(cursor, entry.id, BitcodeBlockIndex::NO_PARENT);
+			}
+		}
+
+	private:
+		void IndexBlock(BitStreamCursor& cursor, uint32_t block_id, uint32_t parent)
+		{
+			uint32_t const index = static_cast<uint32_t>(blocks_.size());
+			uint64_t const bit_offset = cursor.CurrBitNo();
+			blocks_.push_back({ block_id, parent, bit_offset, 0 });
+
+			if (block_id == BitCode::StandardBlockId::BlockInfoBlockId)
+			{
+				// The abbreviations are needed to walk the blocks we descend into.
+				if (cursor.ReadBlockInfoBlock())
+				{
+					TERROR("Malformed block");
+				}
+			}
+			else if ((block_id == BitCode::BlockId::Module)
+				|| (index_function_blocks_ && (block_id == BitCode::BlockId::Function)))
+			{
+				if (cursor.EnterSubBlock(block_id))
+				{
+					TERROR("Malformed block");
+				}
+				this->IndexSubBlocks(cursor, index);
+			}
+			else
+			{
+				if (cursor.SkipBlock())
+				{
+					TERROR("Invalid record");
+				}
+			}
+
+			blocks_[index].num_bits = cursor.CurrBitNo() - bit_offset;
+		}
+
+		void IndexSubBlocks(BitStreamCursor& cursor, uint32_t parent)
+		{
+			for (;;)
+			{
+				BitStreamEntry entry = cursor.Advance();
+				switch (entry.kind)
+				{
+				case BitStreamEntry::Error:
+					TERROR("Malformed block");
+					break;
+
+				case BitStreamEntry::EndBlock:
+					return;
+
+				case BitStreamEntry::SubBlock:
+					this->IndexBlock(cursor, entry.id, parent);
+					break;
+
+				case BitStreamEntry::Record:
+					// Records have no length prefix, so they have to be decoded to get past them.
+					record_.clear();
+					cursor.ReadRecord(entry.id, record_);
+					break;
+				}
+			}
+		}
+
+	private:
+		std::vector<BitcodeBlockIndex::Block>& blocks_;
+		bool index_function_blocks_;
+		boost::container::small_vector<uint64_t, 64> record_;
+	};
+}
+
+namespace Dilithium
+{
+	BitcodeBlockIndex::BitcodeBlockIndex(uint8_t const * data, uint32_t data_length, bool index_function_blocks)
+	{
+		uint8_t const * buff_beg = data;
+		uint8_t const * buff_end = buff_beg + data_length;
+
+		if (data_length & 3)
+		{
+			TERROR("Invalid bitcode size");
+		}
+
+		if (IsBitcodeWrapper(buff_beg, buff_end))
+		{
+			if (SkipBitcodeWrapperHeader(buff_beg, buff_end, true))
+			{
+				TERROR("Invalid bitcode wrapper header");
+			}
+		}
+
+		bitcode_length_ = static_cast<uint32_t>(buff_end - buff_beg);
+		bitcode_hash_ = HashBitcode(buff_beg, bitcode_length_);
+		BlockIndexBuilder(blocks_, index_function_blocks).Build(buff_beg, buff_end);
+	}
+
+	bool BitcodeBlockIndex::Matches(uint8_t const * bitcode, uint32_t bitcode_length) const
+	{
+		return (bitcode_length == bitcode_length_) && (HashBitcode(bitcode, bitcode_length) == bitcode_hash_);
+	}
+
+	uint32_t BitcodeBlockIndex::FindBlockAt(uint64_t bit_offset) const
+	{
+		auto iter = std::lower_bound(blocks_.begin(), blocks_.end(), bit_offset,
+			[](Block const & block, uint64_t offset)
+			{
+				return block.bit_offset < offset;
+			});
+		if ((iter != blocks_.end()) && (iter->bit_offset == bit_offset))
+		{
+			return static_cast<uint32_t>(iter - blocks_.begin());
+		}
+		return this->NumBlocks();
+	}
+
+	uint32_t BitcodeBlockIndex::FindChild(uint32_t parent, uint32_t block_id, uint32_t start) const
+	{
+		for (uint32_t i = start, e = this->NumBlocks(); i < e; ++ i)
+		{
+			if ((blocks_[i].parent == parent) && (blocks_[i].block_id == block_id))
+			{
+				return i;
+			}
+		}
+		return this->NumBlocks();
+	}
+
+	std::vector<uint8_t> BitcodeBlockIndex::Serialize() const
+	{
+		std::vector<uint8_t> ret;
+		ret.reserve(sizeof(IndexHeader) + blocks_.size() * SERIALIZED_BLOCK_SIZE);
+
+		Write(ret, INDEX_FOURCC);
+		Write(ret, INDEX_VERSION);
+		Write(ret, bitcode_length_);
+		Write(ret, this->NumBlocks());
+		Write(ret, bitcode_hash_);
+		for (auto const & block : blocks_)
+		{
+			Write(ret, block.block_id);
+			Write(ret, block.parent);
+			Write(ret, block.bit_offset);
+			Write(ret, block.num_bits);
+		}
+
+		return ret;
+	}
+
+	BitcodeBlockIndex BitcodeBlockIndex::Deserialize(uint8_t const * data, size_t data_length)
+	{
+		if (data_length < sizeof(IndexHeader))
+		{
+			TERROR("Invalid block index");
+		}
+
+		uint8_t const * p = data;
+		IndexHeader header;
+		header.four_cc = Read<uint32_t>(p);
+		header.version = Read<uint32_t>(p);
+		header.bitcode_length = Read<uint32_t>(p);
+		header.num_blocks = Read<uint32_t>(p);
+		header.bitcode_hash = Read<uint64_t>(p);
+		if ((header.four_cc != INDEX_FOURCC) || (header.version != INDEX_VERSION)
+			|| ((data_length - sizeof(IndexHeader)) / SERIALIZED_BLOCK_SIZE < header.num_blocks))
+		{
+			TERROR("Invalid block index");
+		}
+
+		BitcodeBlockIndex ret;
+		ret.bitcode_length_ = header.bitcode_length;
+		ret.bitcode_hash_ = header.bitcode_hash;
+		ret.blocks_.resize(header.num_blocks);
+		uint64_t const num_bitcode_bits = static_cast<uint64_t>(header.bitcode_length) * 8;
+		for (uint32_t i = 0; i < header.num_blocks; ++ i)
+		{
+			auto& block = ret.blocks_[i];
+			block.block_id = Read<uint32_t>(p);
+			block.parent = Read<uint32_t>(p);
+			block.bit_offset = Read<uint64_t>(p);
+			block.num_bits = Read<uint64_t>(p);
+
+			// Parents come first, and blocks stay inside the bitcode and in order.
+			if (((block.parent != NO_PARENT) && (block.parent >= i))
+				|| (block.bit_offset > num_bitcode_bits) || (block.num_bits > num_bitcode_bits - block.bit_offset)
+				|| ((i > 0) && (block.bit_offset <= ret.blocks_[i - 1].bit_offset)))
+			{
+				TERROR("Invalid block index");
+			}
+		}
+
+		return ret;
+	}
+}
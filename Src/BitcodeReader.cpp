@@ -38,8 +38,10 @@
 #include <Dilithium/Attributes.hpp>
 #include <Dilithium/ArrayRef.hpp>
 #include <Dilithium/BasicBlock.hpp>
+#include <Dilithium/BitcodeBlockIndex.hpp>
 #include <Dilithium/BitstreamReader.hpp>
 #include <Dilithium/Casting.hpp>
+#include <Dilithium/ChunkedStreamBuf.hpp>
 #include <Dilithium/Constants.hpp>
 #include <Dilithium/DerivedType.hpp>
 #include <Dilithium/GVMaterializer.hpp>
@@ -47,15 +49,20 @@
 #include <Dilithium/LLVMBitCodes.hpp>
 #include <Dilithium/LLVMContext.hpp>
 #include <Dilithium/LLVMModule.hpp>
+#include <Dilithium/MappedFile.hpp>
 #include <Dilithium/Mathextras.hpp>
 #include <Dilithium/Metadata.hpp>
 #include <Dilithium/SmallString.hpp>
 #include <Dilithium/SymbolTableList.hpp>
+#include <Dilithium/ThreadGroup.hpp>
 #include <Dilithium/TrackingMDRef.hpp>
 #include <Dilithium/Use.hpp>
 #include <Dilithium/ValueHandle.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <deque>
+#include <exception>
 #include <map>
 #include <unordered_map>
 
@@ -107,55 +114,45 @@ namespace
 		return std::error_code(static_cast<int>(e), BitcodeErrorCategory());
 	}
 
-	bool IsBitcodeWrapper(uint8_t const * buf_beg, uint8_t const * buf_end)
-	{
-		return (buf_beg != buf_end)
-			&& (buf_beg[0] == 0xDE) && (buf_beg[1] == 0xC0) && (buf_beg[2] == 0x17) && (buf_beg[3] == 0x0B);
-	}
-
-	bool SkipBitcodeWrapperHeader(uint8_t const *& buf_beg, uint8_t const *& buf_end, bool verify_buff_size)
+	template <typename T>
+	bool ConvertToString(ArrayRef<uint64_t> record, uint32_t idx, T& result)
 	{
-		static uint32_t constexpr KNOWN_HEADER_SIZE = 4 * 4;
-		static uint32_t constexpr OFFSET_FIELD = 2 * 4;
-		static uint32_t constexpr SIZE_FIELD = 3 * 4;
-
-		// Must contain the header!
-		if (buf_end - buf_beg < KNOWN_HEADER_SIZE)
+		if (idx > record.size())
 		{
 			return true;
 		}
-		else
-		{
-			uint32_t offset = boost::endian::little_to_native(*reinterpret_cast<uint32_t const *>(&buf_beg[OFFSET_FIELD]));
-			uint32_t size = boost::endian::little_to_native(*reinterpret_cast<uint32_t const *>(&buf_beg[SIZE_FIELD]));
 
-			// Verify that offset + size fits in the file.
-			if (verify_buff_size && (offset + size > static_cast<uint32_t>(buf_end - buf_beg)))
-			{
-				return true;
-			}
-			else
-			{
-				buf_beg += offset;
-				buf_end = buf_beg + size;
-				return false;
-			}
+		for (uint32_t i = idx, e = static_cast<uint32_t>(record.size()); i != e; ++ i)
+		{
+			result += static_cast<char>(record[i]);
 		}
+
+		return false;
 	}
 
+	// Gets the string operand that starts at record[idx]. For abbreviated records, ReadRecord already hands it out in str.
+	// Otherwise it's widened in the record, and gets narrowed into buff.
 	template <typename T>
-	bool ConvertToString(ArrayRef<uint64_t> record, uint32_t idx, T& result)
+	bool RecordString(ArrayRef<uint64_t> record, uint32_t idx, std::string_view str, T& buff, std::string_view& result)
 	{
-		if (idx > record.size())
+		if (str.data() != nullptr)
 		{
-			return true;
+			if (idx != record.size())
+			{
+				return true;
+			}
+
+			result = str;
+			return false;
 		}
 
-		for (uint32_t i = idx, e = static_cast<uint32_t>(record.size()); i != e; ++ i)
+		buff.clear();
+		if (ConvertToString(record, idx, buff))
 		{
-			result += static_cast<char>(record[i]);
+			return true;
 		}
 
+		result = std::string_view(buff.data(), buff.size());
 		return false;
 	}
 
@@ -586,6 +583,207 @@ namespace
 		std::vector<TrackingMDRef> md_value_ptrs_;
 	};
 
+	// The entries of a function block, decoded ahead of time so that it can be done on a worker thread. They are
+	// replayed through the same calls the parser makes on a BitStreamCursor.
+	class FunctionBodyTape
+	{
+	public:
+		void Decode(BitStreamReader& reader, uint64_t bit_no)
+		{
+			BOOST_ASSERT_MSG(!reader.IsStreamed(), "Streamed readers can't be shared by threads");
+
+			// Function blocks only see BLOCKINFO abbreviations, so a fresh cursor can start right at the block.
+			BitStreamCursor cursor(reader);
+			cursor.JumpToBit(bit_no);
+			if (cursor.EnterSubBlock(BitCode::BlockId::Function))
+			{
+				this->PushEntry(BitStreamEntry::GetError());
+				return;
+			}
+			this->DecodeBlock(cursor, BitCode::BlockId::Function);
+		}
+
+		BitStreamEntry Advance()
+		{
+			BOOST_ASSERT(pos_ < entries_.size());
+			auto const & entry = entries_[pos_].entry;
+			if ((entry.kind == BitStreamEntry::SubBlock) || (entry.kind == BitStreamEntry::EndBlock))
+			{
+				++ pos_;
+			}
+			return entry;
+		}
+
+		BitStreamEntry AdvanceSkippingSubblocks()
+		{
+			for (;;)
+			{
+				BitStreamEntry entry = this->Advance();
+				if (entry.kind != BitStreamEntry::SubBlock)
+				{
+					return entry;
+				}
+				if (this->SkipBlock())
+				{
+					return BitStreamEntry::GetError();
+				}
+			}
+		}
+
+		bool SkipBlock()
+		{
+			for (uint32_t depth = 1; depth != 0; ++ pos_)
+			{
+				BOOST_ASSERT(pos_ < entries_.size());
+				switch (entries_[pos_].entry.kind)
+				{
+				case BitStreamEntry::Error:
+					return true;
+				case BitStreamEntry::SubBlock:
+					++ depth;
+					break;
+				case BitStreamEntry::EndBlock:
+					-- depth;
+					break;
+				default:
+					break;
+				}
+			}
+			return false;
+		}
+
+		uint32_t ReadCode() const
+		{
+			BOOST_ASSERT(pos_ < entries_.size());
+			auto const & entry = entries_[pos_].entry;
+			switch (entry.kind)
+			{
+			case BitStreamEntry::Record:
+				return entry.id;
+			case BitStreamEntry::SubBlock:
+				return BitCode::FixedAbbrevId::EnterSubblock;
+			default:
+				return BitCode::FixedAbbrevId::EndBlock;
+			}
+		}
+
+		uint32_t ReadRecord(uint32_t abbrev_id, boost::container::small_vector_base<uint64_t>& vals, std::string_view* str)
+		{
+			BOOST_ASSERT(pos_ < entries_.size());
+			auto const & entry = entries_[pos_];
+			BOOST_ASSERT((entry.entry.kind == BitStreamEntry::Record) && (entry.entry.id == abbrev_id));
+			DILITHIUM_UNUSED(abbrev_id);
+			++ pos_;
+
+			vals.insert(vals.end(), vals_.begin() + entry.vals_begin, vals_.begin() + entry.vals_begin + entry.num_vals);
+			if (str)
+			{
+				*str = (entry.str_length == NO_STR) ? std::string_view()
+					: std::string_view(chars_.data() + entry.str_begin, entry.str_length);
+			}
+			else if (entry.str_length != NO_STR)
+			{
+				// Widened as ReadRecord would have done without str.
+				for (uint32_t i = 0; i < entry.str_length; ++ i)
+				{
+					vals.push_back(static_cast<uint8_t>(chars_[entry.str_begin + i]));
+				}
+			}
+			return entry.code;
+		}
+
+	private:
+		void DecodeBlock(BitStreamCursor& cursor, uint32_t block_id)
+		{
+			// The same blocks the parser reads strings from.
+			bool const with_str = (block_id == BitCode::BlockId::ValueSymTab) || (block_id == BitCode::BlockId::Metadata);
+
+			boost::container::small_vector<uint64_t, 64> record;
+			std::string_view str;
+			for (;;)
+			{
+				BitStreamEntry entry = cursor.Advance();
+				switch (entry.kind)
+				{
+				case BitStreamEntry::Error:
+					this->PushEntry(entry);
+					return;
+
+				case BitStreamEntry::EndBlock:
+					this->PushEntry(entry);
+					return;
+
+				case BitStreamEntry::SubBlock:
+					this->PushEntry(entry);
+					if (cursor.EnterSubBlock(entry.id))
+					{
+						this->PushEntry(BitStreamEntry::GetError());
+						return;
+					}
+					this->DecodeBlock(cursor, entry.id);
+					if (entries_.back().entry.kind == BitStreamEntry::Error)
+					{
+						return;
+					}
+					break;
+
+				case BitStreamEntry::Record:
+					{
+						record.clear();
+						uint32_t code = cursor.ReadRecord(entry.id, record, with_str ? &str : nullptr);
+						this->PushEntry(entry);
+
+						auto& tape_entry = entries_.back();
+						tape_entry.code = code;
+						tape_entry.vals_begin = static_cast<uint32_t>(vals_.size());
+						tape_entry.num_vals = static_cast<uint32_t>(record.size());
+						vals_.insert(vals_.end(), record.begin(), record.end());
+						if (with_str && (str.data() != nullptr))
+						{
+							tape_entry.str_begin = static_cast<uint32_t>(chars_.size());
+							tape_entry.str_length = static_cast<uint32_t>(str.size());
+							chars_.append(str.data(), str.size());
+						}
+					}
+					break;
+				}
+			}
+		}
+
+		void PushEntry(BitStreamEntry entry)
+		{
+			entries_.push_back({ entry, 0, 0, 0, 0, NO_STR });
+		}
+
+	private:
+		static uint32_t constexpr NO_STR = ~0U;
+
+		struct Entry
+		{
+			BitStreamEntry entry;
+			uint32_t code;
+			uint32_t vals_begin;
+			uint32_t num_vals;
+			uint32_t str_begin;
+			uint32_t str_length;
+		};
+
+		std::vector<Entry> entries_;
+		std::vector<uint64_t> vals_;
+		std::string chars_;
+		size_t pos_ = 0;
+	};
+
+	// The bitcode decoded into tapes at a time. The tapes of a batch take several times that.
+	uint64_t constexpr MAX_DECODE_BATCH_BITS = 1024 * 1024 * 8;
+
+	struct DeferredBody
+	{
+		Function* func;
+		uint64_t bit_no;
+		uint64_t num_bits;
+	};
+
 	class BitcodeReader : boost::noncopyable, public GVMaterializer
 	{
 	public:
@@ -593,9 +791,22 @@ namespace
 			: context_(context), buffer_(data), buffer_length_(data_length), value_list_(*context)
 		{
 		}
+		// The data lies in file. Holding on to file keeps it mapped as long as the reader needs it.
+		BitcodeReader(std::shared_ptr<MappedFile> const & file, uint8_t const * data, uint32_t data_length,
+			std::shared_ptr<LLVMContext> const & context)
+			: context_(context), file_(file), buffer_(data), buffer_length_(data_length), value_list_(*context)
+		{
+			BOOST_ASSERT((data >= file->Data()) && (data + data_length <= file->Data() + file->Size()));
+		}
+		// Pulls data_length bytes of bitcode from source while parsing.
+		BitcodeReader(std::istream& source, uint32_t data_length, std::shared_ptr<LLVMContext> const & context)
+			: context_(context), source_(&source), buffer_length_(data_length), value_list_(*context)
+		{
+		}
 		~BitcodeReader() override
 		{
 			buffer_ = nullptr;
+			source_ = nullptr;
 			buffer_length_ = 0;
 			type_list_.clear();
 			type_list_.shrink_to_fit();
@@ -625,17 +836,58 @@ namespace
 				return;
 			}
 
-			auto dfii = deferred_func_info_.find(func);
-			BOOST_ASSERT_MSG(dfii != deferred_func_info_.end(), "Deferred function not found!");
-			if (dfii->second == 0)
+			// Parsing the body goes through the function's accessors, which mustn't come back here.
+			func->IsMaterializable(false);
+
+			uint32_t const module_value_list_size = static_cast<uint32_t>(value_list_.size());
+			uint32_t const module_md_value_list_size = static_cast<uint32_t>(md_value_list_.size());
+			auto tape_iter = func_body_tapes_.find(func);
+			try
 			{
-				this->FindFunctionInStream(*func, dfii);
-			}
+				if (tape_iter != func_body_tapes_.end())
+				{
+					tape_ = &tape_iter->second;
+					this->ParseFunctionBody(*func);
+					tape_ = nullptr;
+					func_body_tapes_.erase(tape_iter);
+				}
+				else
+				{
+					auto dfii = deferred_func_info_.find(func);
+					BOOST_ASSERT_MSG(dfii != deferred_func_info_.end(), "Deferred function not found!");
+					if (dfii->second == 0)
+					{
+						this->FindFunctionInStream(*func, dfii);
+					}
 
-			stream_cursor_.JumpToBit(dfii->second);
+					stream_cursor_.JumpToBit(dfii->second);
 
-			this->ParseFunctionBody(*func);
-			func->IsMaterializable(false);
+					this->ParseFunctionBody(*func);
+				}
+			}
+			catch (...)
+			{
+				// Drop what was built of the body and leave the function materializable, so the next access parses it
+				// again from the bitcode and reports the same error instead of seeing a truncated body.
+				if (tape_iter != func_body_tapes_.end())
+				{
+					tape_ = nullptr;
+					func_body_tapes_.erase(tape_iter);
+				}
+				for (auto& bb : *func)
+				{
+					bb.DropAllReferences();
+				}
+				func->BasicBlockList().clear();
+				instruction_list_.clear();
+				value_list_.resize(module_value_list_size);
+				md_value_list_.resize(module_md_value_list_size);
+				std::vector<BasicBlock*>().swap(func_bbs_);
+				func->IsMaterializable(true);
+				throw;
+			}
+
+			this->ReleaseConsumedBitcode();
 
 			// TODO: LLVM strips debug information for func here. We haven't implemented debug processing.
 
@@ -654,9 +906,11 @@ namespace
 			// Promise to materialize all forward references.
 			will_materialize_all_forward_refs_ = true;
 
+			this->DecodeAndMaterializeFunctionBodies();
+
 			for (auto func_iter = the_module_->begin(), end_iter = the_module_->end(); func_iter != end_iter; ++ func_iter)
 			{
-				this->Materialize(func_iter->get());
+				this->Materialize(&*func_iter);
 			}
 			if (next_unread_bit_)
 			{
@@ -680,6 +934,32 @@ namespace
 			// TODO: LLVM upgrades debug information. We haven't implemented debug processing.
 		}
 
+		// The index has to be built from the same data, and outlive the parsing.
+		void UseBlockIndex(BitcodeBlockIndex const * block_index)
+		{
+			block_index_ = block_index;
+		}
+
+		// Functions keep only their prototypes, their bodies are skipped without being decoded.
+		void SkipFunctionBodies()
+		{
+			skip_function_bodies_ = true;
+		}
+
+		// Up to num_threads threads, the caller's included, decode the function bodies of a full load. 1 decodes them
+		// on the caller's thread while the IR is built.
+		void DecodeThreads(uint32_t num_threads)
+		{
+			num_decode_threads_ = std::max(num_threads, 1U);
+		}
+
+		// Leaves the source right after the bitcode, even if parsing didn't need all of it.
+		void FinishStream()
+		{
+			BOOST_ASSERT(stream_file_->IsChunked());
+			stream_file_->ChunkedBuffer()->Drain();
+		}
+
 		void MaterializeMetadata() override
 		{
 			for (auto bit_pos : deferred_metadata_info_)
@@ -726,6 +1006,7 @@ namespace
 				if (entry.id == BitCode::BlockId::Module)
 				{
 					this->ParseModule(false, should_lazy_load_metadata);
+					this->ReleaseConsumedBitcode();
 					break;
 				}
 				else
@@ -767,6 +1048,155 @@ namespace
 			this->Error(BitcodeError::CorruptedBitcode, message);
 		}
 
+		// Decodes the bodies of all materializable functions in parallel, if the caller asked for more than one thread,
+		// and materializes them. Only the decoding is parallel. Building the IR from the decoded bodies stays serial and
+		// in order, since LLVMContext's uniquing tables and the use lists aren't thread safe. A tape takes several times
+		// the memory of its bitcode, so the bodies go in batches of at most MAX_DECODE_BATCH_BITS of bitcode, and each
+		// tape is dropped as soon as its body is built.
+		void DecodeAndMaterializeFunctionBodies()
+		{
+			if ((num_decode_threads_ < 2) || stream_file_->IsStreamed())
+			{
+				// One read position only. Besides, a chunked reader would have to pull in everything up front.
+				return;
+			}
+
+			std::vector<DeferredBody> bodies;
+			for (auto& func : *the_module_)
+			{
+				if (!func.IsMaterializable())
+				{
+					continue;
+				}
+
+				auto dfii = deferred_func_info_.find(&func);
+				if (dfii == deferred_func_info_.end())
+				{
+					continue;
+				}
+				if (dfii->second == 0)
+				{
+					this->FindFunctionInStream(func, dfii);
+				}
+				bodies.push_back({ &func, dfii->second, 0 });
+			}
+			if (bodies.size() < 2)
+			{
+				return;
+			}
+
+			// A body reaches at most to the start of the next one, or to the end of the bitcode.
+			std::vector<uint64_t> starts(bodies.size());
+			for (size_t i = 0; i < bodies.size(); ++ i)
+			{
+				starts[i] = bodies[i].bit_no;
+			}
+			std::sort(starts.begin(), starts.end());
+			uint64_t const num_bitcode_bits = static_cast<uint64_t>(stream_file_->BitcodeSize()) * 8;
+			for (auto& body : bodies)
+			{
+				auto next = std::upper_bound(starts.begin(), starts.end(), body.bit_no);
+				body.num_bits = ((next != starts.end()) ? *next : num_bitcode_bits) - body.bit_no;
+			}
+
+			for (size_t batch_begin = 0; batch_begin < bodies.size();)
+			{
+				size_t batch_end = batch_begin + 1;
+				uint64_t batch_bits = bodies[batch_begin].num_bits;
+				while ((batch_end < bodies.size()) && (batch_bits + bodies[batch_end].num_bits <= MAX_DECODE_BATCH_BITS))
+				{
+					batch_bits += bodies[batch_end].num_bits;
+					++ batch_end;
+				}
+
+				this->DecodeFunctionBodies(&bodies[batch_begin], static_cast<uint32_t>(batch_end - batch_begin));
+				for (size_t i = batch_begin; i < batch_end; ++ i)
+				{
+					this->Materialize(bodies[i].func);
+				}
+
+				batch_begin = batch_end;
+			}
+		}
+
+		void DecodeFunctionBodies(DeferredBody const * bodies, uint32_t num_bodies)
+		{
+			uint32_t const num_threads = std::min(num_decode_threads_, num_bodies);
+			if (num_threads < 2)
+			{
+				// Materialize reads a lone body straight from the bitcode.
+				return;
+			}
+
+			std::vector<FunctionBodyTape> tapes(num_bodies);
+			std::vector<std::exception_ptr> errors(num_bodies);
+			std::atomic<uint32_t> next_body(0);
+			auto decode = [this, bodies, num_bodies, &tapes, &errors, &next_body]
+			{
+				for (uint32_t i = next_body ++; i < num_bodies; i = next_body ++)
+				{
+					try
+					{
+						tapes[i].Decode(*stream_file_, bodies[i].bit_no);
+					}
+					catch (...)
+					{
+						errors[i] = std::current_exception();
+					}
+				}
+			};
+
+			{
+				ThreadGroup workers;
+				for (uint32_t i = 1; i < num_threads; ++ i)
+				{
+					if (!workers.Spawn(decode))
+					{
+						break;
+					}
+				}
+				decode();
+			}
+
+			for (uint32_t i = 0; i < num_bodies; ++ i)
+			{
+				if (errors[i])
+				{
+					std::rethrow_exception(errors[i]);
+				}
+				func_body_tapes_.emplace(bodies[i].func, std::move(tapes[i]));
+			}
+		}
+
+		// Where the block parsers get their entries from: the stream cursor, or the tape of the function body being
+		// materialized.
+		BitStreamEntry Advance()
+		{
+			return tape_ ? tape_->Advance() : stream_cursor_.Advance();
+		}
+		BitStreamEntry AdvanceSkippingSubblocks()
+		{
+			return tape_ ? tape_->AdvanceSkippingSubblocks() : stream_cursor_.AdvanceSkippingSubblocks();
+		}
+		bool EnterSubBlock(uint32_t block_id)
+		{
+			// A tape is already inside the block once Advance returned it.
+			return tape_ ? false : stream_cursor_.EnterSubBlock(block_id);
+		}
+		bool SkipBlock()
+		{
+			return tape_ ? tape_->SkipBlock() : stream_cursor_.SkipBlock();
+		}
+		uint32_t ReadCode()
+		{
+			return tape_ ? tape_->ReadCode() : stream_cursor_.ReadCode();
+		}
+		uint32_t ReadRecord(uint32_t abbrev_id, boost::container::small_vector_base<uint64_t>& vals,
+			std::string_view* str = nullptr)
+		{
+			return tape_ ? tape_->ReadRecord(abbrev_id, vals, str) : stream_cursor_.ReadRecord(abbrev_id, vals, str);
+		}
+
 		void MaterializeForwardReferencedFunctions()
 		{
 			if (will_materialize_all_forward_refs_)
@@ -1009,6 +1439,23 @@ namespace
 							seen_first_func_body_ = true;
 						}
 
+						if (skip_function_bodies_)
+						{
+							if (stream_cursor_.SkipBlock())
+							{
+								this->Error("Invalid record");
+								return;
+							}
+							break;
+						}
+
+						if (block_index_ && seen_value_sym_tab_)
+						{
+							// All the function bodies are known already, no need to discover them one by one.
+							this->RememberFunctionBodiesFromIndex();
+							return;
+						}
+
 						this->RememberAndSkipFunctionBody();
 
 						// Suspend parsing when we reach the function bodies. Subsequent
@@ -1208,7 +1655,7 @@ namespace
 
 						// If this is a function with a body, remember the prototype we are
 						// creating now, so that we can match up the body with them later.
-						if (!proto)
+						if (!proto && !skip_function_bodies_)
 						{
 							func->IsMaterializable(true);
 							func_with_bodies_.push_back(func);
@@ -1742,18 +2189,20 @@ namespace
 		}
 		void ParseValueSymbolTable()
 		{
-			if (stream_cursor_.EnterSubBlock(BitCode::BlockId::ValueSymTab))
+			if (this->EnterSubBlock(BitCode::BlockId::ValueSymTab))
 			{
 				this->Error("Invalid record");
 				return;
 			}
 
 			boost::container::small_vector<uint64_t, 64> record;
+			std::string_view name_chars;
 
-			SmallString<128> value_name;
+			SmallString<128> value_name_buff;
+			std::string_view value_name;
 			for (;;)
 			{
-				BitStreamEntry entry = stream_cursor_.AdvanceSkippingSubblocks(0);
+				BitStreamEntry entry = this->AdvanceSkippingSubblocks();
 
 				switch (entry.kind)
 				{
@@ -1771,11 +2220,11 @@ namespace
 				}
 
 				record.clear();
-				switch (stream_cursor_.ReadRecord(entry.id, record))
+				switch (this->ReadRecord(entry.id, record, &name_chars))
 				{
 				case BitCode::ValueSymTabCode::Entry: // VST_ENTRY: [valueid, namechar x N]
 					{
-						if (ConvertToString(record, 1, value_name))
+						if (RecordString(record, 1, name_chars, value_name_buff, value_name))
 						{
 							this->Error("Invalid record");
 							return;
@@ -1788,14 +2237,13 @@ namespace
 						}
 
 						Value* v = value_list_[value_id];
-						v->Name(std::string_view(value_name.data(), value_name.size()));
-						value_name.clear();
+						v->Name(value_name);
 					}
 					break;
 
 				case BitCode::ValueSymTabCode::BbEntry:
 					{
-						if (ConvertToString(record, 1, value_name))
+						if (RecordString(record, 1, name_chars, value_name_buff, value_name))
 						{
 							this->Error("Invalid record");
 							return;
@@ -1807,8 +2255,7 @@ namespace
 							return;
 						}
 
-						bb->Name(std::string_view(value_name.data(), value_name.size()));
-						value_name.clear();
+						bb->Name(value_name);
 					}
 					break;
 
@@ -1819,7 +2266,7 @@ namespace
 		}
 		void ParseConstants()
 		{
-			if (stream_cursor_.EnterSubBlock(BitCode::BlockId::Constants))
+			if (this->EnterSubBlock(BitCode::BlockId::Constants))
 			{
 				this->Error("Invalid record");
 				return;
@@ -1831,7 +2278,7 @@ namespace
 			uint32_t next_cst_no = static_cast<uint32_t>(value_list_.size());
 			for (;;)
 			{
-				BitStreamEntry entry = stream_cursor_.AdvanceSkippingSubblocks(0);
+				BitStreamEntry entry = this->AdvanceSkippingSubblocks();
 
 				switch (entry.kind)
 				{
@@ -1858,7 +2305,7 @@ namespace
 
 				record.clear();
 				Value* v = nullptr;
-				uint32_t bit_code = stream_cursor_.ReadRecord(entry.id, record);
+				uint32_t bit_code = this->ReadRecord(entry.id, record);
 				switch (bit_code)
 				{
 				default:
@@ -1943,6 +2390,42 @@ namespace
 				return;
 			}
 		}
+		void RememberFunctionBodiesFromIndex()
+		{
+			uint32_t const num_blocks = block_index_->NumBlocks();
+			uint32_t i = block_index_->FindBlockAt(stream_cursor_.CurrBitNo());
+			if ((i == num_blocks) || (block_index_->GetBlock(i).block_id != BitCode::BlockId::Function))
+			{
+				this->Error("Block index doesn't match the bitcode");
+				return;
+			}
+
+			// Remembers the run of function bodies starting here. Parsing resumes after it.
+			uint32_t const parent = block_index_->GetBlock(i).parent;
+			for (; i < num_blocks; ++ i)
+			{
+				auto const & block = block_index_->GetBlock(i);
+				if (block.parent != parent)
+				{
+					// Nested in a function body.
+					continue;
+				}
+				if (block.block_id != BitCode::BlockId::Function)
+				{
+					break;
+				}
+
+				if (func_with_bodies_.empty())
+				{
+					this->Error("Insufficient function protos");
+					return;
+				}
+
+				deferred_func_info_[func_with_bodies_.back()] = block.bit_offset;
+				func_with_bodies_.pop_back();
+				next_unread_bit_ = block.bit_offset + block.num_bits;
+			}
+		}
 		void RememberAndSkipMetadata()
 		{
 			uint64_t cur_bit = stream_cursor_.CurrBitNo();
@@ -1955,7 +2438,7 @@ namespace
 		}
 		void ParseFunctionBody(Function& func)
 		{
-			if (stream_cursor_.EnterSubBlock(BitCode::BlockId::Function))
+			if (this->EnterSubBlock(BitCode::BlockId::Function))
 			{
 				this->Error("Invalid record");
 				return;
@@ -1967,7 +2450,7 @@ namespace
 
 			for (auto iter = func.ArgBegin(), end_iter = func.ArgEnd(); iter != end_iter; ++ iter)
 			{
-				value_list_.push_back(iter->get());
+				value_list_.push_back(&*iter);
 			}
 
 			uint32_t next_value_no = static_cast<uint32_t>(value_list_.size());
@@ -1990,7 +2473,7 @@ namespace
 			boost::container::small_vector<uint64_t, 64> record;
 			for (;;)
 			{
-				BitStreamEntry entry = stream_cursor_.Advance();
+				BitStreamEntry entry = this->Advance();
 				switch (entry.kind)
 				{
 				case BitStreamEntry::Error:
@@ -2004,7 +2487,7 @@ namespace
 					switch (entry.id)
 					{
 					default:
-						if (stream_cursor_.SkipBlock())
+						if (this->SkipBlock())
 						{
 							this->Error("Invalid record");
 							return;
@@ -2041,7 +2524,7 @@ namespace
 
 				record.clear();
 				Instruction* inst = nullptr;
-				uint32_t bit_code = stream_cursor_.ReadRecord(entry.id, record);
+				uint32_t bit_code = this->ReadRecord(entry.id, record);
 				switch (bit_code)
 				{
 				case BitCode::FunctionCode::DeclareBlocks: // DECLAREBLOCKS: [nblocks]
@@ -2256,7 +2739,7 @@ namespace
 					return;
 				}
 				// TODO: Store inst in a RAII manner to guarantee exception safty
-				cur_bb->InstList().push_back(std::unique_ptr<Instruction>(inst));
+				cur_bb->InstList().push_back(inst);
 				AddToSymbolTableList(inst, cur_bb);
 
 				if (isa<TerminatorInst>(inst))
@@ -2294,7 +2777,7 @@ namespace
 #ifdef DILITHIUM_DEBUG
 			for (auto& func : *the_module_)
 			{
-				BOOST_ASSERT((func->Name().size() <= 8) || (func->Name().find("llvm.") != 0));
+				BOOST_ASSERT((func.Name().size() <= 8) || (func.Name().find("llvm.") != 0));
 			}
 #endif
 
@@ -2381,17 +2864,19 @@ namespace
 			is_metadata_materialized_ = true;
 			uint32_t next_md_value_no = static_cast<uint32_t>(md_value_list_.size());
 
-			if (stream_cursor_.EnterSubBlock(BitCode::BlockId::Metadata))
+			if (this->EnterSubBlock(BitCode::BlockId::Metadata))
 			{
 				this->Error("Invalid record");
 				return;
 			}
 
 			boost::container::small_vector<uint64_t, 64> record;
+			std::string_view record_chars;
+			SmallString<128> chars_buff;
 
 			for (;;)
 			{
-				BitStreamEntry entry = stream_cursor_.AdvanceSkippingSubblocks(0);
+				BitStreamEntry entry = this->AdvanceSkippingSubblocks();
 
 				switch (entry.kind)
 				{
@@ -2409,17 +2894,23 @@ namespace
 				}
 
 				record.clear();
-				uint32_t code = stream_cursor_.ReadRecord(entry.id, record);
+				uint32_t code = this->ReadRecord(entry.id, record, &record_chars);
 				bool distinct = false;
 				switch (code)
 				{
 				case BitCode::MetadataCode::Name:
 					{
-						SmallString<8> name(record.begin(), record.end());
+						std::string_view name_chars;
+						if (RecordString(record, 0, record_chars, chars_buff, name_chars))
+						{
+							this->Error("Invalid record");
+							return;
+						}
+						SmallString<8> name(name_chars);
 						record.clear();
-						code = stream_cursor_.ReadCode();
+						code = this->ReadCode();
 
-						uint32_t next_bit_code = stream_cursor_.ReadRecord(code, record);
+						uint32_t next_bit_code = this->ReadRecord(code, record);
 						if (next_bit_code != BitCode::MetadataCode::NamedNode)
 						{
 							this->Error("MetadataCode::Name not followed by MetadataCode::NamedNode");
@@ -2518,7 +3009,12 @@ namespace
 
 				case BitCode::MetadataCode::String:
 					{
-						std::string str(record.begin(), record.end());
+						std::string_view str;
+						if (RecordString(record, 0, record_chars, chars_buff, str))
+						{
+							this->Error("Invalid record");
+							return;
+						}
 						// TODO: LLVM upgrades the MDStringConstant here. But it doesn't seems we need it for DXIL.
 						BOOST_ASSERT(str != "llvm.vectorizer.unroll");
 						BOOST_ASSERT(str.find("llvm.vectorizer.") != 0);
@@ -2530,15 +3026,20 @@ namespace
 
 				case BitCode::MetadataCode::Kind:
 					{
-						if (record.size() < 2)
+						if (record.empty())
 						{
 							this->Error("Invalid record");
 							return;
 						}
 
 						uint32_t kind = static_cast<uint32_t>(record[0]);
-						SmallString<8> name(record.begin() + 1, record.end());
-						uint32_t new_kind = the_module_->MdKindId(name.str());
+						std::string_view name;
+						if (RecordString(record, 1, record_chars, chars_buff, name) || name.empty())
+						{
+							this->Error("Invalid record");
+							return;
+						}
+						uint32_t new_kind = the_module_->MdKindId(name);
 						if (!md_kind_map_.insert(std::make_pair(kind, new_kind)).second)
 						{
 							this->Error("Conflicting MetadataCode::Kind records");
@@ -2556,7 +3057,7 @@ namespace
 		{
 			DILITHIUM_UNUSED(func);
 
-			if (stream_cursor_.EnterSubBlock(BitCode::BlockId::MetadataAttachment))
+			if (this->EnterSubBlock(BitCode::BlockId::MetadataAttachment))
 			{
 				this->Error("Invalid record");
 				return;
@@ -2565,7 +3066,7 @@ namespace
 			boost::container::small_vector<uint64_t, 64> record;
 			for (;;)
 			{
-				BitStreamEntry entry = stream_cursor_.AdvanceSkippingSubblocks(0);
+				BitStreamEntry entry = this->AdvanceSkippingSubblocks();
 
 				switch (entry.kind)
 				{
@@ -2583,7 +3084,7 @@ namespace
 				}
 
 				record.clear();
-				switch (stream_cursor_.ReadRecord(entry.id, record))
+				switch (this->ReadRecord(entry.id, record))
 				{
 				case BitCode::MetadataCode::Attachment:
 					DILITHIUM_NOT_IMPLEMENTED;
@@ -2596,7 +3097,7 @@ namespace
 		}
 		void ParseUseLists()
 		{
-			if (stream_cursor_.EnterSubBlock(BitCode::BlockId::UseList))
+			if (this->EnterSubBlock(BitCode::BlockId::UseList))
 			{
 				this->Error("Invalid record");
 				return;
@@ -2605,7 +3106,7 @@ namespace
 			boost::container::small_vector<uint64_t, 64> record;
 			for (;;)
 			{
-				BitStreamEntry entry = stream_cursor_.AdvanceSkippingSubblocks(0);
+				BitStreamEntry entry = this->AdvanceSkippingSubblocks();
 
 				switch (entry.kind)
 				{
@@ -2625,7 +3126,7 @@ namespace
 				// Read a use list record.
 				record.clear();
 				bool bb = false;
-				switch (stream_cursor_.ReadRecord(entry.id, record))
+				switch (this->ReadRecord(entry.id, record))
 				{
 				case BitCode::UseListCode::Bb:
 					bb = true;
@@ -2683,27 +3184,75 @@ namespace
 
 		void InitStream()
 		{
-			uint8_t const * buff_beg = buffer_;
-			uint8_t const * buff_end = buff_beg + buffer_length_;
-
 			if (buffer_length_ & 3)
 			{
 				TERROR("Invalid bitcode size"); // HLSL Change - bitcode size is the problem, not the signature per se
 			}
 
-			// If we have a wrapper header, parse it and ignore the non-bc file contents.
-			// The magic number is 0x0B17C0DE stored in little endian.
-			if (IsBitcodeWrapper(buff_beg, buff_end))
+			if (source_)
 			{
-				if (SkipBitcodeWrapperHeader(buff_beg, buff_end, true))
+				// Streamed bitcode has no wrapper header, it starts right at the signature.
+				stream_file_ = std::make_unique<BitStreamReader>(std::make_unique<ChunkedStreamBuf>(*source_, buffer_length_));
+			}
+			else
+			{
+				uint8_t const * buff_beg = buffer_;
+				uint8_t const * buff_end = buff_beg + buffer_length_;
+
+				// If we have a wrapper header, parse it and ignore the non-bc file contents.
+				// The magic number is 0x0B17C0DE stored in little endian.
+				if (IsBitcodeWrapper(buff_beg, buff_end))
 				{
-					TERROR("Invalid bitcode wrapper header");
+					if (SkipBitcodeWrapperHeader(buff_beg, buff_end, true))
+					{
+						TERROR("Invalid bitcode wrapper header");
+					}
 				}
+
+				stream_file_ = std::make_unique<BitStreamReader>(buff_beg, buff_end);
+			}
+
+			if (stream_file_->BitcodeSize() == 0)
+			{
+				// There isn't even a signature. An empty range can also come with a null start, which nothing after
+				// this can read from.
+				TERROR("Invalid bitcode signature");
+			}
+
+			if (block_index_ && (stream_file_->IsStreamed()
+				|| !block_index_->Matches(stream_file_->BitcodeStart(), stream_file_->BitcodeSize())))
+			{
+				TERROR("Block index doesn't match the bitcode");
 			}
 
-			stream_file_ = std::make_unique<BitStreamReader>(buff_beg, buff_end);
 			stream_cursor_.Init(stream_file_.get());
 		}
+		// With a chunked reader, drops the bitcode before the earliest position parsing can still come back to.
+		void ReleaseConsumedBitcode()
+		{
+			if (!stream_file_->IsChunked())
+			{
+				return;
+			}
+
+			uint64_t keep_from = stream_cursor_.CurrBitNo();
+			if (next_unread_bit_)
+			{
+				keep_from = std::min(keep_from, next_unread_bit_);
+			}
+			for (auto const & dfi : deferred_func_info_)
+			{
+				if ((dfi.second != 0) && dfi.first->IsMaterializable())
+				{
+					keep_from = std::min(keep_from, dfi.second);
+				}
+			}
+			for (auto bit_pos : deferred_metadata_info_)
+			{
+				keep_from = std::min(keep_from, bit_pos);
+			}
+			stream_file_->Release(keep_from);
+		}
 		void FindFunctionInStream(Function& func, std::unordered_map<Function*, uint64_t>::iterator deferred_func_info_iter)
 		{
 			DILITHIUM_UNUSED(func);
@@ -2722,15 +3271,20 @@ namespace
 		}
 
 	private:
-		std::shared_ptr<LLVMContext> const & context_;
+		std::shared_ptr<LLVMContext> context_;
 
 		LLVMModule* the_module_ = nullptr;
+		std::shared_ptr<MappedFile> file_;
 		uint8_t const * buffer_ = nullptr;
+		std::istream* source_ = nullptr;
 		uint32_t buffer_length_ = 0;
 		std::unique_ptr<BitStreamReader> stream_file_;
 		BitStreamCursor stream_cursor_;
 		uint64_t next_unread_bit_ = 0;
 		bool seen_value_sym_tab_ = false;
+		BitcodeBlockIndex const * block_index_ = nullptr;
+		bool skip_function_bodies_ = false;
+		uint32_t num_decode_threads_ = 1;
 
 		std::vector<Type*> type_list_;
 		BitcodeReaderValueList value_list_;
@@ -2754,6 +3308,9 @@ namespace
 		std::unordered_map<Function*, uint64_t> deferred_func_info_;
 		std::vector<uint64_t> deferred_metadata_info_;
 
+		std::unordered_map<Function*, FunctionBodyTape> func_body_tapes_;
+		FunctionBodyTape* tape_ = nullptr;
+
 		std::unordered_map<Function*, std::vector<BasicBlock*>> basic_block_fwd_refs_;
 		std::deque<Function*> basic_block_fwd_ref_queue_;
 		bool use_relative_ids_ = false;
@@ -2761,19 +3318,189 @@ namespace
 		bool is_metadata_materialized_ = false;
 		std::vector<StructType*> identified_struct_types_;
 	};
+
+	std::shared_ptr<LLVMContext> CreateContext(std::shared_ptr<LLVMContextPrelude const> const & prelude)
+	{
+		return prelude ? std::make_shared<LLVMContext>(prelude) : std::make_shared<LLVMContext>();
+	}
 }
 
 namespace Dilithium
 {
-	std::unique_ptr<LLVMModule> LoadLLVMModule(uint8_t const * data, uint32_t data_length, std::string const & name)
+	bool IsBitcodeWrapper(uint8_t const * buf_beg, uint8_t const * buf_end)
+	{
+		return (buf_beg != buf_end)
+			&& (buf_beg[0] == 0xDE) && (buf_beg[1] == 0xC0) && (buf_beg[2] == 0x17) && (buf_beg[3] == 0x0B);
+	}
+
+	bool SkipBitcodeWrapperHeader(uint8_t const *& buf_beg, uint8_t const *& buf_end, bool verify_buff_size)
+	{
+		static uint32_t constexpr KNOWN_HEADER_SIZE = 4 * 4;
+		static uint32_t constexpr OFFSET_FIELD = 2 * 4;
+		static uint32_t constexpr SIZE_FIELD = 3 * 4;
+
+		// Must contain the header!
+		if (buf_end - buf_beg < KNOWN_HEADER_SIZE)
+		{
+			return true;
+		}
+		else
+		{
+			uint32_t offset = boost::endian::little_to_native(*reinterpret_cast<uint32_t const *>(&buf_beg[OFFSET_FIELD]));
+			uint32_t size = boost::endian::little_to_native(*reinterpret_cast<uint32_t const *>(&buf_beg[SIZE_FIELD]));
+
+			// Verify that offset + size fits in the file.
+			if (verify_buff_size && (offset + size > static_cast<uint32_t>(buf_end - buf_beg)))
+			{
+				return true;
+			}
+			else
+			{
+				buf_beg += offset;
+				buf_end = buf_beg + size;
+				return false;
+			}
+		}
+	}
+
+	BitcodeSource::BitcodeSource(uint8_t const * data, uint32_t data_length)
+		: data_(data), data_length_(data_length)
+	{
+	}
+
+	BitcodeSource::BitcodeSource(std::shared_ptr<MappedFile> const & file, uint8_t const * data, uint32_t data_length)
+		: file_(file), data_(data), data_length_(data_length)
+	{
+		BOOST_ASSERT((data >= file->Data()) && (data + data_length <= file->Data() + file->Size()));
+	}
+
+	BitcodeSource::BitcodeSource(std::shared_ptr<MappedFile> const & file)
+		: file_(file), data_(file->Data())
+	{
+		if (file->Size() > UINT32_MAX)
+		{
+			TERROR("Bitcode file too large");
+		}
+		data_length_ = static_cast<uint32_t>(file->Size());
+	}
+
+	BitcodeSource::BitcodeSource(std::istream& source, uint32_t data_length)
+		: stream_(&source), data_length_(data_length)
+	{
+	}
+
+	std::unique_ptr<LLVMModule> LoadLLVMModule(BitcodeSource const & source, std::string const & name,
+		LoadOptions const & options)
 	{
-		auto context = std::make_shared<LLVMContext>();
-		auto reader = std::make_shared<BitcodeReader>(data, data_length, context);
+		auto context = CreateContext(options.prelude);
+		std::shared_ptr<BitcodeReader> reader;
+		if (source.Stream())
+		{
+			if ((options.mode != BitcodeLoadMode::Full) || options.block_index)
+			{
+				TERROR("A stream can only be fully loaded, without a block index.");
+			}
+			reader = std::make_shared<BitcodeReader>(*source.Stream(), source.DataLength(), context);
+		}
+		else if (source.File())
+		{
+			reader = std::make_shared<BitcodeReader>(source.File(), source.Data(), source.DataLength(), context);
+		}
+		else
+		{
+			reader = std::make_shared<BitcodeReader>(source.Data(), source.DataLength(), context);
+		}
+
 		auto mod = std::make_unique<LLVMModule>(name, context);
-		mod->Materializer(reader);
-		reader->ParseBitcodeInto(mod.get(), false);
-		mod->MaterializeAllPermanently();
+		reader->UseBlockIndex(options.block_index);
+		switch (options.mode)
+		{
+		case BitcodeLoadMode::WithoutBodies:
+			// Nothing is left to materialize, so the reader goes away with the parsing.
+			reader->SkipFunctionBodies();
+			reader->ParseBitcodeInto(mod.get(), false);
+			break;
+
+		case BitcodeLoadMode::Lazy:
+			mod->Materializer(reader);
+			reader->ParseBitcodeInto(mod.get(), false);
+			break;
+
+		default:
+			mod->Materializer(reader);
+			reader->DecodeThreads(options.num_decode_threads);
+			reader->ParseBitcodeInto(mod.get(), false);
+			mod->MaterializeAllPermanently();
+			if (source.Stream())
+			{
+				reader->FinishStream();
+			}
+			break;
+		}
 
 		return std::move(mod);
 	}
+
+	std::unique_ptr<LLVMModule> LoadLLVMModule(uint8_t const * data, uint32_t data_length, std::string const & name,
+		std::shared_ptr<LLVMContextPrelude const> const & prelude, uint32_t num_decode_threads)
+	{
+		return LoadLLVMModule(BitcodeSource(data, data_length), name,
+			LoadOptions{ BitcodeLoadMode::Full, nullptr, prelude, num_decode_threads });
+	}
+
+	std::unique_ptr<LLVMModule> LoadLLVMModule(uint8_t const * data, uint32_t data_length, std::string const & name,
+		BitcodeBlockIndex const & block_index, std::shared_ptr<LLVMContextPrelude const> const & prelude,
+		uint32_t num_decode_threads)
+	{
+		return LoadLLVMModule(BitcodeSource(data, data_length), name,
+			LoadOptions{ BitcodeLoadMode::Full, &block_index, prelude, num_decode_threads });
+	}
+
+	std::unique_ptr<LLVMModule> LoadLLVMModule(std::shared_ptr<MappedFile> const & file, uint8_t const * data,
+		uint32_t data_length, std::string const & name, std::shared_ptr<LLVMContextPrelude const> const & prelude,
+		uint32_t num_decode_threads)
+	{
+		return LoadLLVMModule(BitcodeSource(file, data, data_length), name,
+			LoadOptions{ BitcodeLoadMode::Full, nullptr, prelude, num_decode_threads });
+	}
+
+	std::unique_ptr<LLVMModule> LoadLLVMModuleFromFile(std::string const & file_name, std::string const & name,
+		std::shared_ptr<LLVMContextPrelude const> const & prelude, uint32_t num_decode_threads)
+	{
+		return LoadLLVMModule(BitcodeSource(std::make_shared<MappedFile>(file_name)), name,
+			LoadOptions{ BitcodeLoadMode::Full, nullptr, prelude, num_decode_threads });
+	}
+
+	std::unique_ptr<LLVMModule> LoadLazyLLVMModule(uint8_t const * data, uint32_t data_length, std::string const & name,
+		std::shared_ptr<LLVMContextPrelude const> const & prelude)
+	{
+		return LoadLLVMModule(BitcodeSource(data, data_length), name, LoadOptions{ BitcodeLoadMode::Lazy, nullptr, prelude });
+	}
+
+	std::unique_ptr<LLVMModule> LoadLazyLLVMModule(std::shared_ptr<MappedFile> const & file, uint8_t const * data,
+		uint32_t data_length, std::string const & name, std::shared_ptr<LLVMContextPrelude const> const & prelude)
+	{
+		return LoadLLVMModule(BitcodeSource(file, data, data_length), name,
+			LoadOptions{ BitcodeLoadMode::Lazy, nullptr, prelude });
+	}
+
+	std::unique_ptr<LLVMModule> LoadLLVMModuleWithoutBodies(uint8_t const * data, uint32_t data_length,
+		std::string const & name, std::shared_ptr<LLVMContextPrelude const> const & prelude)
+	{
+		return LoadLLVMModule(BitcodeSource(data, data_length), name,
+			LoadOptions{ BitcodeLoadMode::WithoutBodies, nullptr, prelude });
+	}
+
+	std::unique_ptr<LLVMModule> LoadLLVMModuleWithoutBodies(std::shared_ptr<MappedFile> const & file, uint8_t const * data,
+		uint32_t data_length, std::string const & name, std::shared_ptr<LLVMContextPrelude const> const & prelude)
+	{
+		return LoadLLVMModule(BitcodeSource(file, data, data_length), name,
+			LoadOptions{ BitcodeLoadMode::WithoutBodies, nullptr, prelude });
+	}
+
+	std::unique_ptr<LLVMModule> LoadLLVMModule(std::istream& source, uint32_t data_length, std::string const & name,
+		std::shared_ptr<LLVMContextPrelude const> const & prelude)
+	{
+		return LoadLLVMModule(BitcodeSource(source, data_length), name, LoadOptions{ BitcodeLoadMode::Full, nullptr, prelude });
+	}
 }
@@ -33,57 +33,122 @@
  */
 
 #include <Dilithium/BitStreamReader.hpp>
+#include <Dilithium/MathExtras.hpp>
+
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+	#define DILITHIUM_VBR6_BMI2
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+		#include <immintrin.h>
+	#endif
+#endif
 
 namespace
 {
 	using namespace Dilithium;
 
-	uint64_t ReadAbbreviatedField(BitStreamCursor& cursor, BitCodeAbbrevOp const & op)
-	{
-		BOOST_ASSERT_MSG(!op.IsLiteral(), "Not to be used with literals!");
+	// A 64-bit window holds at least 57 valid bits, which is 9 whole VBR6 chunks.
+	uint32_t constexpr VBR6_CHUNKS_PER_WINDOW = 9;
+	uint32_t constexpr VBR6_WINDOW_BITS = VBR6_CHUNKS_PER_WINDOW * 6;
+	// Continuation bit (bit 5) and payload bits (bits 0-4) of every chunk in the window.
+	uint64_t constexpr VBR6_CONTINUATION_MASK = 0x20820820820820ULL;
+	uint64_t constexpr VBR6_PAYLOAD_MASK = 0x1F7DF7DF7DF7DFULL;
 
-		switch (op.Encoding())
+	// Decodes the VBR6 values that end inside the window, at most max_vals of them. Returns the number of
+	// values decoded and the number of bits they took.
+	typedef uint32_t (*Vbr6WindowDecoder)(uint64_t window, uint64_t* vals, uint32_t max_vals, uint32_t& bits_used);
+
+	uint32_t DecodeVbr6Window(uint64_t window, uint64_t* vals, uint32_t max_vals, uint32_t& bits_used)
+	{
+		// Each clear continuation bit terminates a value.
+		uint64_t ends = ~window & VBR6_CONTINUATION_MASK;
+		uint32_t num_vals = 0;
+		uint32_t start = 0;
+		while (ends && (num_vals < max_vals))
 		{
-		case BitCodeAbbrevOp::BitCodeEncoding::Array:
-		case BitCodeAbbrevOp::BitCodeEncoding::Blob:
-			DILITHIUM_UNREACHABLE("Should not reach here");
-		case BitCodeAbbrevOp::BitCodeEncoding::Fixed:
-			BOOST_ASSERT(op.EncodingData() <= cursor.MAX_CHUNK_SIZE);
-			return cursor.Read(static_cast<uint32_t>(op.EncodingData()));
-		case BitCodeAbbrevOp::BitCodeEncoding::VBR:
-			BOOST_ASSERT(op.EncodingData() <= cursor.MAX_CHUNK_SIZE);
-			return cursor.ReadVBR64(static_cast<uint32_t>(op.EncodingData()));
-		case BitCodeAbbrevOp::BitCodeEncoding::Char6:
-			return BitCodeAbbrevOp::DecodeChar6(static_cast<uint32_t>(cursor.Read(6)));
+			uint32_t const end = static_cast<uint32_t>(CountTrailingZeros(ends)) + 1;
+			uint64_t chunks = (window >> start) & ((1ULL << (end - start)) - 1);
+			uint64_t val = chunks & 0x1F;
+			for (uint32_t shift = 5; chunks >>= 6; shift += 5)
+			{
+				val |= (chunks & 0x1F) << shift;
+			}
+			vals[num_vals] = val;
+			++ num_vals;
 
-		default:
-			DILITHIUM_UNREACHABLE("invalid abbreviation encoding");
+			start = end;
+			ends &= ends - 1;
 		}
+		bits_used = start;
+		return num_vals;
 	}
 
-	void SkipAbbreviatedField(BitStreamCursor& cursor, BitCodeAbbrevOp const & op)
+#ifdef DILITHIUM_VBR6_BMI2
+#ifndef _MSC_VER
+	__attribute__((target("bmi2")))
+#endif
+	uint32_t DecodeVbr6WindowBmi2(uint64_t window, uint64_t* vals, uint32_t max_vals, uint32_t& bits_used)
 	{
-		BOOST_ASSERT_MSG(!op.IsLiteral(), "Not to be used with literals!");
+		uint64_t ends = ~window & VBR6_CONTINUATION_MASK;
+		uint32_t num_vals = 0;
+		uint32_t start = 0;
+		while (ends && (num_vals < max_vals))
+		{
+			uint32_t const end = static_cast<uint32_t>(CountTrailingZeros(ends)) + 1;
+			if (end - start == 6)
+			{
+				vals[num_vals] = (window >> start) & 0x1F;
+			}
+			else
+			{
+				// Multi-chunk value, gather all its payload bits in one go.
+				uint64_t const range = ((1ULL << end) - 1) & ~((1ULL << start) - 1);
+				vals[num_vals] = _pext_u64(window, VBR6_PAYLOAD_MASK & range);
+			}
+			++ num_vals;
+
+			start = end;
+			ends &= ends - 1;
+		}
+		bits_used = start;
+		return num_vals;
+	}
 
-		switch (op.Encoding())
+	bool CpuHasBmi2()
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
 		{
-		case BitCodeAbbrevOp::BitCodeEncoding::Fixed:
-			BOOST_ASSERT(op.EncodingData() <= cursor.MAX_CHUNK_SIZE);
-			cursor.Read(static_cast<uint32_t>(op.EncodingData()));
-			break;
-		case BitCodeAbbrevOp::BitCodeEncoding::VBR:
-			BOOST_ASSERT(op.EncodingData() <= cursor.MAX_CHUNK_SIZE);
-			cursor.ReadVBR64(static_cast<uint32_t>(op.EncodingData()));
-			break;
-		case BitCodeAbbrevOp::BitCodeEncoding::Char6:
-			cursor.Read(6);
-			break;
+			return false;
+		}
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 8)) != 0;
+#else
+		uint32_t eax, ebx, ecx, edx;
+		if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+		{
+			return false;
+		}
+		return (ebx & bit_BMI2) != 0;
+#endif
+	}
+#endif
 
-		case BitCodeAbbrevOp::BitCodeEncoding::Array:
-		case BitCodeAbbrevOp::BitCodeEncoding::Blob:
-		default:
-			DILITHIUM_UNREACHABLE("Should not reach here");
+	Vbr6WindowDecoder SelectVbr6WindowDecoder()
+	{
+#ifdef DILITHIUM_VBR6_BMI2
+		if (CpuHasBmi2())
+		{
+			return DecodeVbr6WindowBmi2;
 		}
+#endif
+		return DecodeVbr6Window;
 	}
 }
 
@@ -92,16 +157,34 @@ namespace Dilithium
 	BitStreamReader::BitStreamReader(uint8_t const * beg, uint8_t const * end)
 	{
 		BOOST_ASSERT_MSG(((end - beg) & 3) == 0, "Bitcode stream not a multiple of 4 bytes");
-		bitcode_buff_ = std::make_unique<MemStreamBuf>(beg, end);
-		bitcode_stream_ = std::make_unique<std::istream>(bitcode_buff_.get());
 		bitcode_begin_ = beg;
 		bitcode_size_ = static_cast<uint32_t>(end - beg);
 	}
 
+	BitStreamReader::BitStreamReader(std::unique_ptr<std::streambuf> buff, uint32_t size)
+	{
+		BOOST_ASSERT_MSG((size & 3) == 0, "Bitcode stream not a multiple of 4 bytes");
+		bitcode_buff_ = std::move(buff);
+		bitcode_stream_ = std::make_unique<std::istream>(bitcode_buff_.get());
+		bitcode_size_ = size;
+	}
+
+	BitStreamReader::BitStreamReader(std::unique_ptr<ChunkedStreamBuf> buff)
+	{
+		BOOST_ASSERT_MSG(buff->Size() <= UINT32_MAX, "Bitcode stream too large");
+		BOOST_ASSERT_MSG((buff->Size() & 3) == 0, "Bitcode stream not a multiple of 4 bytes");
+		chunked_buff_ = buff.get();
+		bitcode_size_ = static_cast<uint32_t>(buff->Size());
+		bitcode_buff_ = std::move(buff);
+		bitcode_stream_ = std::make_unique<std::istream>(bitcode_buff_.get());
+	}
+
 	BitStreamReader::BitStreamReader(BitStreamReader&& rhs)
 	{
 		bitcode_buff_ = std::move(rhs.bitcode_buff_);
 		bitcode_stream_ = std::move(rhs.bitcode_stream_);
+		chunked_buff_ = rhs.chunked_buff_;
+		rhs.chunked_buff_ = nullptr;
 		bitcode_begin_ = rhs.bitcode_begin_;
 		bitcode_size_ = rhs.bitcode_size_;
 		block_info_records_ = std::move(rhs.block_info_records_);
@@ -113,6 +196,8 @@ namespace Dilithium
 		{
 			bitcode_buff_ = std::move(rhs.bitcode_buff_);
 			bitcode_stream_ = std::move(rhs.bitcode_stream_);
+			chunked_buff_ = rhs.chunked_buff_;
+			rhs.chunked_buff_ = nullptr;
 			bitcode_begin_ = rhs.bitcode_begin_;
 			bitcode_size_ = rhs.bitcode_size_;
 			block_info_records_ = std::move(rhs.block_info_records_);
@@ -120,6 +205,15 @@ namespace Dilithium
 		return *this;
 	}
 
+	void BitStreamReader::Release(uint64_t bit_no)
+	{
+		if (chunked_buff_)
+		{
+			// Cursors jump to whole words, so keep the word bit_no is in.
+			chunked_buff_->Release((bit_no / 8) & ~static_cast<uint64_t>(sizeof(size_t) - 1));
+		}
+	}
+
 	BitStreamReader::BlockInfo* BitStreamReader::GetBlockInfo(uint32_t block_id)
 	{
 		if (!block_info_records_.empty() && (block_info_records_.back().block_id == block_id))
@@ -200,12 +294,23 @@ namespace Dilithium
 		size_ = 0;
 		bits_in_curr_word_ = 0;
 		curr_code_size_ = 2;
+
+		// A streamed reader has only one read position, so every cursor starts by rewinding it.
+		if (bit_stream_ && bit_stream_->IsStreamed())
+		{
+			bit_stream_->BitcodeStream().clear();
+			bit_stream_->BitcodeStream().seekg(0);
+		}
 	}
 
 	void BitStreamCursor::FreeState()
 	{
-		curr_abbrevs_.clear();
+		local_abbrevs_.clear();
 		block_scope_.clear();
+		curr_block_id_ = ~0U;
+		info_abbrevs_ = nullptr;
+		num_info_abbrevs_ = 0;
+		local_abbrevs_base_ = 0;
 	}
 
 	bool BitStreamCursor::AtEndOfStream()
@@ -275,8 +380,12 @@ namespace Dilithium
 		uint32_t word_bit_no = static_cast<uint32_t>(bit_no & (sizeof(word_t) * 8 - 1));
 		BOOST_ASSERT_MSG(this->CanSkipToPos(byte_no), "Invalid location");
 
-		bit_stream_->BitcodeStream().seekg(byte_no);
-		next_char_ = bit_stream_->BitcodeStream().tellg();
+		if (bit_stream_->IsStreamed())
+		{
+			bit_stream_->BitcodeStream().clear();
+			bit_stream_->BitcodeStream().seekg(byte_no);
+		}
+		next_char_ = byte_no;
 		bits_in_curr_word_ = 0;
 
 		if (word_bit_no > 0)
@@ -292,11 +401,48 @@ namespace Dilithium
 			ReportFatalError("Unexpected end of file");
 		}
 
+		if (bit_stream_->IsStreamed())
+		{
+			this->FillCurrWordFromStream();
+			return;
+		}
+		uint8_t const * bitcode = bit_stream_->BitcodeStart();
+
+		size_t const bitcode_size = bit_stream_->BitcodeSize();
+		if (next_char_ >= bitcode_size)
+		{
+			size_ = bitcode_size;
+			return;
+		}
+
+		// Unaligned little-endian load straight from the bitcode. Only the last word of the stream can be partial.
+		size_t const bytes_left = bitcode_size - next_char_;
+		if (bytes_left >= sizeof(word_t))
+		{
+			std::memcpy(&curr_word_, bitcode + next_char_, sizeof(word_t));
+			curr_word_ = boost::endian::little_to_native(curr_word_);
+			bits_in_curr_word_ = static_cast<uint32_t>(sizeof(word_t) * 8);
+			next_char_ += sizeof(word_t);
+		}
+		else
+		{
+			uint8_t data[sizeof(word_t)] = { 0 };
+			std::memcpy(data, bitcode + next_char_, bytes_left);
+			std::memcpy(&curr_word_, data, sizeof(word_t));
+			curr_word_ = boost::endian::little_to_native(curr_word_);
+			bits_in_curr_word_ = static_cast<uint32_t>(bytes_left * 8);
+			next_char_ += bytes_left;
+		}
+	}
+
+	void BitStreamCursor::FillCurrWordFromStream()
+	{
 		char data[sizeof(word_t)] = { 0 };
 
-		bit_stream_->BitcodeStream().read(data, sizeof(data));
-		auto bytes_read = bit_stream_->BitcodeStream().gcount();
-		next_char_ = bit_stream_->BitcodeStream().tellg();
+		auto& stream = bit_stream_->BitcodeStream();
+		stream.read(data, sizeof(data));
+		auto bytes_read = static_cast<size_t>(stream.gcount());
+		next_char_ += bytes_read;
 
 		if (bytes_read == 0)
 		{
@@ -304,7 +450,8 @@ namespace Dilithium
 			return;
 		}
 
-		curr_word_ = boost::endian::little_to_native(*reinterpret_cast<word_t*>(data));
+		std::memcpy(&curr_word_, data, sizeof(word_t));
+		curr_word_ = boost::endian::little_to_native(curr_word_);
 		bits_in_curr_word_ = static_cast<uint32_t>(bytes_read * 8);
 	}
 
@@ -401,6 +548,59 @@ namespace Dilithium
 		}
 	}
 
+	void BitStreamCursor::ReadVBR6Array(uint64_t* vals, uint32_t num_vals)
+	{
+		uint64_t bit_no = this->CurrBitNo();
+		uint64_t const end_bit_no = static_cast<uint64_t>(bit_stream_->BitcodeSize()) * 8;
+		if (num_vals * 6ULL > end_bit_no - bit_no)
+		{
+			ReportFatalError("Unexpected end of file");
+		}
+
+		uint8_t const * bitcode = bit_stream_->BitcodeStart();
+		if (!bitcode || (num_vals < MIN_BULK_VBR6_VALUES))
+		{
+			for (uint32_t i = 0; i < num_vals; ++ i)
+			{
+				vals[i] = this->ReadVBR64(6);
+			}
+			return;
+		}
+
+		static Vbr6WindowDecoder const decode_window = SelectVbr6WindowDecoder();
+
+		// Decode straight from the bitcode, as long as a whole window can be loaded.
+		uint32_t i = 0;
+		while ((i < num_vals) && (bit_no + 64 <= end_bit_no))
+		{
+			uint64_t window;
+			std::memcpy(&window, bitcode + bit_no / 8, sizeof(window));
+			window = boost::endian::little_to_native(window) >> (bit_no & 7);
+
+			uint32_t bits_used;
+			uint32_t const decoded = decode_window(window, vals + i, num_vals - i, bits_used);
+			if (decoded == 0)
+			{
+				// Value wider than a window, leave it to the cursor.
+				this->JumpToBit(bit_no);
+				vals[i] = this->ReadVBR64(6);
+				++ i;
+				bit_no = this->CurrBitNo();
+			}
+			else
+			{
+				i += decoded;
+				bit_no += bits_used;
+			}
+		}
+
+		this->JumpToBit(bit_no);
+		for (; i < num_vals; ++ i)
+		{
+			vals[i] = this->ReadVBR64(6);
+		}
+	}
+
 	bool BitStreamCursor::SkipBlock()
 	{
 		// Read and ignore the codelen value.  Since we are skipping this block, we
@@ -422,14 +622,11 @@ namespace Dilithium
 
 	bool BitStreamCursor::EnterSubBlock(uint32_t block_id, uint32_t* num_words_ptr)
 	{
-		block_scope_.push_back(Block(curr_code_size_));
-		block_scope_.back().prev_abbrevs.swap(curr_abbrevs_);
+		block_scope_.push_back(Block(curr_code_size_, curr_block_id_, num_info_abbrevs_, local_abbrevs_base_));
 
 		auto info = bit_stream_->GetBlockInfo(block_id);
-		if (info)
-		{
-			curr_abbrevs_.insert(curr_abbrevs_.end(), info->abbrevs.begin(), info->abbrevs.end());
-		}
+		this->SetAbbrevScope(block_id, info ? static_cast<uint32_t>(info->abbrevs.size()) : 0,
+			static_cast<uint32_t>(local_abbrevs_.size()));
 
 		curr_code_size_ = this->ReadVBR(BitCode::StandardWidth::CodeLenWidth);
 		if (curr_code_size_ > MAX_CHUNK_SIZE)
@@ -466,132 +663,229 @@ namespace Dilithium
 	BitCodeAbbrev const * BitStreamCursor::GetAbbrev(uint32_t abbrev_id)
 	{
 		uint32_t abbrev_no = abbrev_id - BitCode::FixedAbbrevId::FirstApplicationAbbrev;
-		if (abbrev_no >= curr_abbrevs_.size())
+		if (abbrev_no < num_info_abbrevs_)
+		{
+			return &info_abbrevs_[abbrev_no];
+		}
+
+		abbrev_no -= num_info_abbrevs_;
+		if (abbrev_no >= local_abbrevs_.size() - local_abbrevs_base_)
 		{
 			ReportFatalError("Invalid abbrev number");
 		}
-		return curr_abbrevs_[abbrev_no].get();
+		return &local_abbrevs_[local_abbrevs_base_ + abbrev_no];
 	}
 
-	uint32_t BitStreamCursor::ReadRecord(uint32_t abbrev_id, boost::container::small_vector_base<uint64_t>& vals)
+	uint32_t BitStreamCursor::ReadRecord(uint32_t abbrev_id, boost::container::small_vector_base<uint64_t>& vals,
+		std::string_view* str)
 	{
+		if (str)
+		{
+			*str = std::string_view();
+		}
+
 		if (abbrev_id == BitCode::FixedAbbrevId::UnabbrevRecord)
 		{
 			uint32_t code = this->ReadVBR(6);
 			uint32_t num_elems = this->ReadVBR(6);
-			for (uint32_t i = 0; i != num_elems; ++ i)
+			// Every operand takes at least 6 bits. Checked before sizing the output, so a corrupt count can't allocate
+			// far more than the bitcode could hold.
+			if (num_elems * 6ULL > static_cast<uint64_t>(bit_stream_->BitcodeSize()) * 8 - this->CurrBitNo())
 			{
-				vals.push_back(this->ReadVBR64(6));
+				ReportFatalError("Unexpected end of file");
 			}
+			size_t const old_size = vals.size();
+			vals.resize(old_size + num_elems, boost::container::default_init);
+			this->ReadVBR6Array(vals.data() + old_size, num_elems);
 			return code;
 		}
 
 		auto abbv = this->GetAbbrev(abbrev_id);
+		auto const * step = abbv->DecodeSteps();
+		auto const * const steps_end = step + abbv->NumDecodeSteps();
 
-		BOOST_ASSERT_MSG(abbv->NumOperandInfos() != 0, "no record code in abbreviation?");
-		auto const & code_op = abbv->OperandInfo(0);
 		uint32_t code;
-		if (code_op.IsLiteral())
+		switch (step->kind)
 		{
-			code = static_cast<uint32_t>(code_op.LiteralValue());
-		}
-		else
-		{
-			if ((code_op.Encoding() == BitCodeAbbrevOp::BitCodeEncoding::Array)
-				|| (code_op.Encoding() == BitCodeAbbrevOp::BitCodeEncoding::Blob))
-			{
-				ReportFatalError("Abbreviation starts with an Array or a Blob");
-			}
-			code = static_cast<uint32_t>(ReadAbbreviatedField(*this, code_op));
+		case BitCodeAbbrev::DecodeStep::Kind::Literal:
+			code = static_cast<uint32_t>(step->literal);
+			break;
+		case BitCodeAbbrev::DecodeStep::Kind::Fixed:
+			code = static_cast<uint32_t>(this->Read(step->width));
+			break;
+		case BitCodeAbbrev::DecodeStep::Kind::VBR:
+			code = static_cast<uint32_t>(this->ReadVBR64(step->width));
+			break;
+		case BitCodeAbbrev::DecodeStep::Kind::Char6:
+			code = BitCodeAbbrevOp::DecodeChar6(static_cast<uint32_t>(this->Read(6)));
+			break;
+
+		default:
+			DILITHIUM_UNREACHABLE("Abbreviation starts with an Array or a Blob");
 		}
 
-		for (uint32_t i = 1, e = abbv->NumOperandInfos(); i != e; ++ i)
+		for (++ step; step != steps_end; ++ step)
 		{
-			auto const & op = abbv->OperandInfo(i);
-			if (op.IsLiteral())
+			switch (step->kind)
 			{
-				vals.push_back(op.LiteralValue());
-				continue;
-			}
-
-			if ((op.Encoding() != BitCodeAbbrevOp::BitCodeEncoding::Array)
-				&& (op.Encoding() != BitCodeAbbrevOp::BitCodeEncoding::Blob))
-			{
-				vals.push_back(ReadAbbreviatedField(*this, op));
-				continue;
-			}
-
-			if (op.Encoding() == BitCodeAbbrevOp::BitCodeEncoding::Array)
-			{
-				uint32_t num_elems = this->ReadVBR(6);
+			case BitCodeAbbrev::DecodeStep::Kind::Literal:
+				vals.push_back(step->literal);
+				break;
+			case BitCodeAbbrev::DecodeStep::Kind::Fixed:
+				vals.push_back(this->Read(step->width));
+				break;
+			case BitCodeAbbrev::DecodeStep::Kind::VBR:
+				vals.push_back(this->ReadVBR64(step->width));
+				break;
+			case BitCodeAbbrev::DecodeStep::Kind::Char6:
+				vals.push_back(BitCodeAbbrevOp::DecodeChar6(static_cast<uint32_t>(this->Read(6))));
+				break;
 
-				if (i + 2 != e)
+			case BitCodeAbbrev::DecodeStep::Kind::ArrayFixed:
 				{
-					ReportFatalError("Array op not second to last");
+					uint32_t num_elems = this->ReadVBR(6);
+					if (str && (step->width <= 8))
+					{
+						str_scratch_.resize(num_elems);
+						for (uint32_t i = 0; i < num_elems; ++ i)
+						{
+							str_scratch_[i] = static_cast<char>(this->Read(step->width));
+						}
+						*str = std::string_view(str_scratch_.data(), num_elems);
+					}
+					else
+					{
+						for (; num_elems; -- num_elems)
+						{
+							vals.push_back(this->Read(step->width));
+						}
+					}
 				}
-				++ i;
-				auto const & elem_enc = abbv->OperandInfo(i);
-				if (!elem_enc.IsEncoding())
+				break;
+			case BitCodeAbbrev::DecodeStep::Kind::ArrayVBR:
 				{
-					ReportFatalError("Array element type has to be an encoding of a type");
+					uint32_t num_elems = this->ReadVBR(6);
+					for (; num_elems; -- num_elems)
+					{
+						vals.push_back(this->ReadVBR64(step->width));
+					}
 				}
-				if ((elem_enc.Encoding() == BitCodeAbbrevOp::BitCodeEncoding::Array)
-					|| (elem_enc.Encoding() == BitCodeAbbrevOp::BitCodeEncoding::Blob))
+				break;
+			case BitCodeAbbrev::DecodeStep::Kind::ArrayChar6:
 				{
-					ReportFatalError("Array element type can't be an Array or a Blob");
+					uint32_t num_elems = this->ReadVBR(6);
+					if (str)
+					{
+						str_scratch_.resize(num_elems);
+						for (uint32_t i = 0; i < num_elems; ++ i)
+						{
+							str_scratch_[i] = BitCodeAbbrevOp::DecodeChar6(static_cast<uint32_t>(this->Read(6)));
+						}
+						*str = std::string_view(str_scratch_.data(), num_elems);
+					}
+					else
+					{
+						for (; num_elems; -- num_elems)
+						{
+							vals.push_back(BitCodeAbbrevOp::DecodeChar6(static_cast<uint32_t>(this->Read(6))));
+						}
+					}
 				}
+				break;
 
-				// Read all the elements.
-				for (; num_elems; --num_elems)
+			case BitCodeAbbrev::DecodeStep::Kind::Blob:
+				if (!this->ReadBlob(vals, str))
 				{
-					vals.push_back(ReadAbbreviatedField(*this, elem_enc));
+					return code;
 				}
+				break;
 
-				continue;
+			default:
+				DILITHIUM_UNREACHABLE("Invalid decode step");
 			}
+		}
 
-			BOOST_ASSERT(op.Encoding() == BitCodeAbbrevOp::BitCodeEncoding::Blob);
+		return code;
+	}
 
-			uint32_t num_elems = this->ReadVBR(6);
-			this->SkipToFourByteBoundary();  // 32-bit alignment
+	bool BitStreamCursor::ReadBlob(boost::container::small_vector_base<uint64_t>& vals, std::string_view* blob)
+	{
+		uint32_t num_elems = this->ReadVBR(6);
+		this->SkipToFourByteBoundary();  // 32-bit alignment
 
-			// Figure out where the end of this blob will be including tail padding.
-			size_t curr_bit_pos = this->CurrBitNo();
-			size_t new_end = curr_bit_pos + ((num_elems + 3) & ~3) * 8;
+		// Figure out where the end of this blob will be including tail padding.
+		size_t curr_bit_pos = this->CurrBitNo();
+		size_t new_end = curr_bit_pos + ((num_elems + 3) & ~3) * 8;
 
-			if (!this->CanSkipToPos(new_end / 8))
+		if (!this->CanSkipToPos(new_end / 8))
+		{
+			if (blob)
+			{
+				str_scratch_.assign(num_elems, '\0');
+				*blob = std::string_view(str_scratch_.data(), num_elems);
+			}
+			else
 			{
 				vals.insert(vals.end(), num_elems, 0);
+			}
+			if (bit_stream_->IsStreamed())
+			{
 				bit_stream_->BitcodeStream().seekg(0, std::ios_base::end);
-				next_char_ = bit_stream_->BitcodeStream().tellg();
-				break;
 			}
+			next_char_ = bit_stream_->BitcodeSize();
+			bits_in_curr_word_ = 0;
+			return false;
+		}
 
+		if (!bit_stream_->IsStreamed())
+		{
 			uint8_t const * ptr = bit_stream_->BitcodeStart() + curr_bit_pos / 8;
-
-			for (; num_elems; -- num_elems)
+			if (blob)
 			{
-				vals.push_back(*ptr);
-				++ ptr;
+				// Points right into the bitcode, no copy.
+				*blob = std::string_view(reinterpret_cast<char const *>(ptr), num_elems);
+			}
+			else
+			{
+				vals.insert(vals.end(), ptr, ptr + num_elems);
+			}
+		}
+		else
+		{
+			auto& stream = bit_stream_->BitcodeStream();
+			stream.clear();
+			stream.seekg(curr_bit_pos / 8);
+			if (blob)
+			{
+				str_scratch_.resize(num_elems);
+				stream.read(&str_scratch_[0], num_elems);
+				*blob = std::string_view(str_scratch_.data(), num_elems);
+			}
+			else
+			{
+				for (; num_elems; -- num_elems)
+				{
+					vals.push_back(static_cast<uint8_t>(stream.get()));
+				}
 			}
-
-			// Skip over tail padding.
-			this->JumpToBit(new_end);
 		}
 
-		return code;
+		// Skip over tail padding.
+		this->JumpToBit(new_end);
+		return true;
 	}
 
 	void BitStreamCursor::ReadAbbrevRecord()
 	{
-		auto abbv = std::make_shared<BitCodeAbbrev>();
+		local_abbrevs_.emplace_back();
+		auto& abbv = local_abbrevs_.back();
 		uint32_t num_op_info = this->ReadVBR(5);
 		for (uint32_t i = 0; i != num_op_info; ++ i)
 		{
 			bool is_literal = this->Read(1);
 			if (is_literal)
 			{
-				abbv->Add(BitCodeAbbrevOp(this->ReadVBR64(8)));
+				abbv.Add(BitCodeAbbrevOp(this->ReadVBR64(8)));
 				continue;
 			}
 
@@ -603,7 +897,7 @@ namespace Dilithium
 				if (((enc == BitCodeAbbrevOp::BitCodeEncoding::Fixed) || (enc == BitCodeAbbrevOp::BitCodeEncoding::VBR))
 					&& (data == 0))
 				{
-					abbv->Add(BitCodeAbbrevOp(0));
+					abbv.Add(BitCodeAbbrevOp(0));
 					continue;
 				}
 
@@ -613,19 +907,15 @@ namespace Dilithium
 					ReportFatalError("Fixed or VBR abbrev record with size > MaxChunkData");
 				}
 
-				abbv->Add(BitCodeAbbrevOp(enc, data));
+				abbv.Add(BitCodeAbbrevOp(enc, data));
 			}
 			else
 			{
-				abbv->Add(BitCodeAbbrevOp(enc));
+				abbv.Add(BitCodeAbbrevOp(enc));
 			}
 		}
 
-		if (abbv->NumOperandInfos() == 0)
-		{
-			ReportFatalError("Abbrev record with no operands");
-		}
-		curr_abbrevs_.push_back(abbv);
+		abbv.Compile();
 	}
 
 	bool BitStreamCursor::ReadBlockInfoBlock()
@@ -668,8 +958,8 @@ namespace Dilithium
 				}
 				this->ReadAbbrevRecord();
 
-				curr_block_info->abbrevs.push_back(std::move(curr_abbrevs_.back()));
-				curr_abbrevs_.pop_back();
+				curr_block_info->abbrevs.push_back(std::move(local_abbrevs_.back()));
+				local_abbrevs_.pop_back();
 				continue;
 			}
 
@@ -721,9 +1011,23 @@ namespace Dilithium
 
 	void BitStreamCursor::PopBlockScope()
 	{
-		curr_code_size_ = block_scope_.back().prev_code_size;
+		auto const & block = block_scope_.back();
+		curr_code_size_ = block.prev_code_size;
 
-		curr_abbrevs_ = std::move(block_scope_.back().prev_abbrevs);
+		// Drop the abbreviations defined in the block being left. The storage is kept for the next block.
+		local_abbrevs_.erase(local_abbrevs_.begin() + local_abbrevs_base_, local_abbrevs_.end());
+		this->SetAbbrevScope(block.prev_block_id, block.prev_num_info_abbrevs, block.prev_local_abbrevs_base);
 		block_scope_.pop_back();
 	}
+
+	void BitStreamCursor::SetAbbrevScope(uint32_t block_id, uint32_t num_info_abbrevs, uint32_t local_abbrevs_base)
+	{
+		curr_block_id_ = block_id;
+		num_info_abbrevs_ = num_info_abbrevs;
+		local_abbrevs_base_ = local_abbrevs_base;
+
+		// Looked up again every time, since reading a BLOCKINFO block can move the block info records around.
+		auto info = (num_info_abbrevs != 0) ? bit_stream_->GetBlockInfo(block_id) : nullptr;
+		info_abbrevs_ = info ? info->abbrevs.data() : nullptr;
+	}
 }
\ No newline at end of file
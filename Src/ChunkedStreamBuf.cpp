@@ -0,0 +1,203 @@
+/**
+ * @file ChunkedStreamBuf.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of Dilithium
+ * For the latest info, see https://github.com/gongminmin/Dilithium
+ *
+ * @section LICENSE
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Minmin Gong. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <Dilithium/ChunkedStreamBuf.hpp>
+#include <Dilithium/Util.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#include <boost/assert.hpp>
+
+namespace Dilithium
+{
+	ChunkedStreamBuf::ChunkedStreamBuf(std::istream& source, uint64_t size, uint32_t chunk_size)
+		: source_(source), size_(size), chunk_size_(chunk_size),
+			first_chunk_pos_(0), num_bytes_fetched_(0), peak_bytes_resident_(0), current_(0)
+	{
+		BOOST_ASSERT(chunk_size_ > 0);
+	}
+
+	void ChunkedStreamBuf::Release(uint64_t pos)
+	{
+		while (!chunks_.empty() && (first_chunk_pos_ + chunks_.front().size() <= pos))
+		{
+			first_chunk_pos_ += chunks_.front().size();
+			chunks_.pop_front();
+		}
+	}
+
+	void ChunkedStreamBuf::Drain()
+	{
+		if (num_bytes_fetched_ < size_)
+		{
+			source_.ignore(static_cast<std::streamsize>(size_ - num_bytes_fetched_));
+			num_bytes_fetched_ += static_cast<uint64_t>(source_.gcount());
+			size_ = num_bytes_fetched_;
+		}
+
+		chunks_.clear();
+		first_chunk_pos_ = num_bytes_fetched_;
+		current_ = std::min(std::max(current_, first_chunk_pos_), size_);
+	}
+
+	ChunkedStreamBuf::int_type ChunkedStreamBuf::uflow()
+	{
+		char_type const * c = this->Fetch(current_);
+		if (!c)
+		{
+			return traits_type::eof();
+		}
+
+		++ current_;
+		return traits_type::to_int_type(*c);
+	}
+
+	ChunkedStreamBuf::int_type ChunkedStreamBuf::underflow()
+	{
+		char_type const * c = this->Fetch(current_);
+		if (!c)
+		{
+			return traits_type::eof();
+		}
+
+		return traits_type::to_int_type(*c);
+	}
+
+	std::streamsize ChunkedStreamBuf::xsgetn(char_type* s, std::streamsize count)
+	{
+		std::streamsize copied = 0;
+		while (copied < count)
+		{
+			char_type const * src = this->Fetch(current_);
+			if (!src)
+			{
+				break;
+			}
+
+			// Up to the end of the chunk holding current_.
+			uint64_t const in_chunk = chunk_size_ - (current_ - first_chunk_pos_) % chunk_size_;
+			uint64_t const available = std::min(in_chunk, num_bytes_fetched_ - current_);
+			auto const n = static_cast<std::streamsize>(std::min<uint64_t>(available, count - copied));
+			memcpy(s + copied, src, static_cast<size_t>(n * sizeof(char_type)));
+			copied += n;
+			current_ += n;
+		}
+		return copied;
+	}
+
+	std::streamsize ChunkedStreamBuf::showmanyc()
+	{
+		BOOST_ASSERT(current_ <= size_);
+		return static_cast<std::streamsize>(size_ - current_);
+	}
+
+	ChunkedStreamBuf::pos_type ChunkedStreamBuf::seekoff(off_type off, std::ios_base::seekdir way,
+		std::ios_base::openmode which)
+	{
+		switch (way)
+		{
+		case std::ios_base::beg:
+			break;
+
+		case std::ios_base::end:
+			off += static_cast<off_type>(size_);
+			break;
+
+		case std::ios_base::cur:
+		default:
+			off += static_cast<off_type>(current_);
+			break;
+		}
+
+		return this->seekpos(off, which);
+	}
+
+	ChunkedStreamBuf::pos_type ChunkedStreamBuf::seekpos(pos_type sp, std::ios_base::openmode which)
+	{
+		BOOST_ASSERT(which == std::ios_base::in);
+		DILITHIUM_UNUSED(which);
+
+		// Only moves the position. The chunks are pulled in when something is read there.
+		off_type const off = sp;
+		if ((off >= static_cast<off_type>(first_chunk_pos_)) && (off <= static_cast<off_type>(size_)))
+		{
+			current_ = static_cast<uint64_t>(off);
+		}
+		else
+		{
+			sp = -1;
+		}
+
+		return sp;
+	}
+
+	ChunkedStreamBuf::char_type const * ChunkedStreamBuf::Fetch(uint64_t pos)
+	{
+		if (pos < first_chunk_pos_)
+		{
+			return nullptr;
+		}
+
+		while (pos >= num_bytes_fetched_)
+		{
+			if (num_bytes_fetched_ >= size_)
+			{
+				return nullptr;
+			}
+
+			auto const n = static_cast<size_t>(std::min<uint64_t>(chunk_size_, size_ - num_bytes_fetched_));
+			chunks_.emplace_back(n);
+			auto& chunk = chunks_.back();
+			source_.read(chunk.data(), n);
+			auto const bytes_read = static_cast<size_t>(source_.gcount());
+			if (bytes_read < n)
+			{
+				// The source ended early. What made it through is all there is.
+				size_ = num_bytes_fetched_ + bytes_read;
+				if (bytes_read == 0)
+				{
+					chunks_.pop_back();
+					return nullptr;
+				}
+				chunk.resize(bytes_read);
+			}
+			num_bytes_fetched_ += bytes_read;
+			peak_bytes_resident_ = std::max(peak_bytes_resident_, this->NumBytesResident());
+		}
+
+		uint64_t const off = pos - first_chunk_pos_;
+		return &chunks_[static_cast<size_t>(off / chunk_size_)][static_cast<size_t>(off % chunk_size_)];
+	}
+}
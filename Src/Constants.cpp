@@ -70,11 +70,34 @@ namespace Dilithium
 	ConstantInt* ConstantInt::Get(LLVMContext& context, MPInt const & v)
 	{
 		auto& impl = context.Impl();
-		auto& slot = impl.int_constants[v];
+
+		ConstantInt** slot_ptr = nullptr;
+		uint32_t const width_index = LLVMContextImpl::SmallIntWidthIndex(v.BitWidth());
+		if (width_index < LLVMContextImpl::NUM_SMALL_INT_WIDTHS)
+		{
+			int64_t const sv = v.SExtValue();
+			int64_t const small_min = LLVMContextImpl::SmallIntMin(v.BitWidth());
+			int64_t const small_max = LLVMContextImpl::SmallIntMax(v.BitWidth());
+			if ((sv >= small_min) && (sv <= small_max))
+			{
+				auto& table = impl.small_int_constants[width_index];
+				if (table.empty())
+				{
+					table.resize(static_cast<size_t>(small_max - small_min + 1));
+				}
+				slot_ptr = &table[static_cast<size_t>(sv - small_min)];
+			}
+		}
+		if (!slot_ptr)
+		{
+			slot_ptr = &impl.int_constants[v];
+		}
+
+		auto& slot = *slot_ptr;
 		if (!slot)
 		{
 			IntegerType* ity = IntegerType::Get(context, v.BitWidth());
-			slot = new ConstantInt(ity, v);
+			slot = new (context, 0) ConstantInt(ity, v);
 		}
 		BOOST_ASSERT(slot->GetType() == IntegerType::Get(context, v.BitWidth()));
 		return slot;
@@ -202,7 +225,7 @@ namespace Dilithium
 		auto& entry = ty->Context().Impl().uv_constants[ty];
 		if (!entry)
 		{
-			entry = new UndefValue(ty);
+			entry = new (ty->Context(), 0) UndefValue(ty);
 		}
 		return entry;
 	}
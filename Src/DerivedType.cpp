@@ -100,18 +100,15 @@ namespace Dilithium
 	{
 		auto& impl = return_type->Context().Impl();
 
-		uint64_t hash_val = boost::hash_value(return_type);
-		boost::hash_combine(hash_val, boost::hash_range(params.begin(), params.end()));
-		boost::hash_combine(hash_val, is_var_args);
-
-		auto iter = impl.function_types.find(hash_val);
-		if (iter == impl.function_types.end())
+		FunctionTypeKeyInfo::KeyTy const key(return_type, params, is_var_args);
+		size_t const hash_val = FunctionTypeKeyInfo::HashValue(key);
+		auto ft = impl.function_types.Find(key, hash_val);
+		if (!ft)
 		{
-			auto ft = std::make_unique<FunctionType>(return_type, params, is_var_args);
-			iter = impl.function_types.emplace(hash_val, std::move(ft)).first;
+			ft = impl.function_types.Insert(new FunctionType(return_type, params, is_var_args), hash_val);
 		}
 
-		return iter->second.get();
+		return ft;
 	}
 
 	FunctionType* FunctionType::Get(Type* return_type, bool is_var_args)
@@ -217,17 +214,25 @@ namespace Dilithium
 
 	StructType* StructType::Get(LLVMContext& context, ArrayRef<Type*> elements, bool is_packed)
 	{
-		DILITHIUM_UNUSED(context);
-		DILITHIUM_UNUSED(elements);
-		DILITHIUM_UNUSED(is_packed);
-		DILITHIUM_NOT_IMPLEMENTED;
+		auto& impl = context.Impl();
+
+		AnonStructTypeKeyInfo::KeyTy const key(elements, is_packed);
+		size_t const hash_val = AnonStructTypeKeyInfo::HashValue(key);
+		auto st = impl.anon_struct_types.Find(key, hash_val);
+		if (!st)
+		{
+			st = new StructType(context);
+			st->SubclassData(SCDB_IsLiteral);
+			st->Body(elements, is_packed);
+			impl.anon_struct_types.Insert(st, hash_val);
+		}
+
+		return st;
 	}
 
 	StructType* StructType::Get(LLVMContext& context, bool is_packed)
 	{
-		DILITHIUM_UNUSED(context);
-		DILITHIUM_UNUSED(is_packed);
-		DILITHIUM_NOT_IMPLEMENTED;
+		return StructType::Get(context, ArrayRef<Type*>(), is_packed);
 	}
 
 	StructType* StructType::Get(Type* type, ...)
@@ -254,9 +259,16 @@ namespace Dilithium
 
 	void StructType::Body(ArrayRef<Type*> elements, bool is_packed)
 	{
-		DILITHIUM_UNUSED(elements);
-		DILITHIUM_UNUSED(is_packed);
-		DILITHIUM_NOT_IMPLEMENTED;
+		BOOST_ASSERT_MSG(this->IsOpaque(), "Struct body already set!");
+
+		uint32_t scdb = this->SubclassData() | SCDB_HasBody;
+		if (is_packed)
+		{
+			scdb |= SCDB_Packed;
+		}
+		this->SubclassData(scdb);
+
+		contained_types_.assign(elements.begin(), elements.end());
 	}
 
 	void StructType::Body(Type* type, ...)
@@ -267,8 +279,8 @@ namespace Dilithium
 
 	bool StructType::IsValidElementType(Type* elem_type)
 	{
-		DILITHIUM_UNUSED(elem_type);
-		DILITHIUM_NOT_IMPLEMENTED;
+		return !elem_type->IsVoidType() && !elem_type->IsLabelType() && !elem_type->IsMetadataType()
+			&& !elem_type->IsFunctionType();
 	}
 
 	bool StructType::IsLayoutIdentical(StructType* rhs) const
@@ -36,6 +36,7 @@
 #include <Dilithium/Function.hpp>
 #include <Dilithium/DerivedType.hpp>
 #include <Dilithium/LLVMContext.hpp>
+#include <Dilithium/LLVMModule.hpp>
 #include <Dilithium/SymbolTableList.hpp>
 #include "LLVMContextImpl.hpp"
 
@@ -55,7 +56,7 @@ namespace Dilithium
 
 		if (mod)
 		{
-			mod->FunctionList().push_back(std::unique_ptr<Function>(this));
+			mod->FunctionList().push_back(this);
 			AddToSymbolTableList(this, mod);
 		}
 	}
@@ -66,14 +67,11 @@ namespace Dilithium
 
 		this->DropAllReferences();
 		argument_list_.clear();
-
-		// FIXME: needed by operator delete
-		this->GlobalVariableOrFunctionNumOperands(1);
 	}
 
 	Function* Function::Create(FunctionType* ty, LinkageTypes linkage, std::string_view name, LLVMModule* mod)
 	{
-		return new Function(ty, linkage, name, mod);
+		return new (ty->Context(), 1) Function(ty, linkage, name, mod);
 	}
 
 	bool Function::HasPersonalityFn() const
@@ -278,7 +276,7 @@ namespace Dilithium
 
 		for (auto iter = this->begin(), end_iter = this->end(); iter != end_iter; ++ iter)
 		{
-			iter->get()->DropAllReferences();
+			iter->DropAllReferences();
 		}
 
 		basic_blocks_.clear();
@@ -299,13 +297,25 @@ namespace Dilithium
 		}
 	}
 
+	void Function::CheckMaterialized() const
+	{
+		if (this->IsMaterializable())
+		{
+			auto mod = const_cast<LLVMModule*>(this->Parent());
+			if (mod)
+			{
+				mod->Materialize(const_cast<Function*>(this));
+			}
+		}
+	}
+
 	void Function::BuildLazyArguments() const
 	{
 		FunctionType* ft = this->GetFunctionType();
 		for (uint32_t i = 0, e = ft->NumParams(); i != e; ++ i)
 		{
 			BOOST_ASSERT_MSG(!ft->ParamType(i)->IsVoidType(), "Cannot have void typed arguments!");
-			argument_list_.push_back(std::make_unique<Argument>(ft->ParamType(i)));
+			argument_list_.push_back(new (this->Context()) Argument(ft->ParamType(i)));
 		}
 
 		uint16_t sdc = this->GetSubclassDataFromValue();
@@ -33,9 +33,16 @@
  */
 
 #include <Dilithium/dxc/HLSL/DxilContainer.hpp>
+#include <Dilithium/BitcodeReader.hpp>
+#include <Dilithium/ErrorHandling.hpp>
+#include <Dilithium/LLVMModule.hpp>
+#include <Dilithium/MappedFile.hpp>
+#include <Dilithium/dxc/HLSL/DxilMdHelper.hpp>
 
 #include <cstddef>
 
+#include <boost/assert.hpp>
+
 namespace Dilithium
 {
 	DxilContainerHeader const * IsDxilContainerLike(void const * ptr, size_t length)
@@ -145,4 +152,194 @@ namespace Dilithium
 			&& (length >= (header->SizeInUint32 * sizeof(uint32_t)))
 			&& IsValidDxilBitcodeHeader(&header->BitcodeHeader, length - offsetof(DxilProgramHeader, BitcodeHeader));
 	}
+
+	DxilContainerView::DxilContainerView(void const * data, size_t length)
+	{
+		auto container = IsDxilContainerLike(data, length);
+		if (!container || !IsValidDxilContainer(container, length))
+		{
+			return;
+		}
+
+		header_ = container;
+		for (uint32_t i = 0; i < container->PartCount; ++ i)
+		{
+			auto part = GetDxilContainerPart(container, i);
+			uint32_t const index = KnownPartIndex(part->PartFourCC);
+			if ((index < NUM_KNOWN_PARTS) && !first_parts_[index])
+			{
+				first_parts_[index] = part;
+			}
+		}
+	}
+
+	DxilPartHeader const * DxilContainerView::Part(uint32_t index) const
+	{
+		BOOST_ASSERT(index < this->PartCount());
+		return GetDxilContainerPart(header_, index);
+	}
+
+	DxilPartHeader const * DxilContainerView::FindPart(uint32_t four_cc) const
+	{
+		uint32_t const index = KnownPartIndex(four_cc);
+		if (index < NUM_KNOWN_PARTS)
+		{
+			return first_parts_[index];
+		}
+
+		for (uint32_t i = 0; i < this->PartCount(); ++ i)
+		{
+			auto part = GetDxilContainerPart(header_, i);
+			if (part->PartFourCC == four_cc)
+			{
+				return part;
+			}
+		}
+		return nullptr;
+	}
+
+	ArrayRef<uint8_t> DxilContainerView::PartData(uint32_t four_cc) const
+	{
+		auto part = this->FindPart(four_cc);
+		if (!part)
+		{
+			return ArrayRef<uint8_t>();
+		}
+		return ArrayRef<uint8_t>(reinterpret_cast<uint8_t const *>(GetDxilPartData(part)), part->PartSize);
+	}
+
+	template <typename T>
+	T const * DxilContainerView::PartAs(uint32_t four_cc) const
+	{
+		auto data = this->PartData(four_cc);
+		return (data.size() >= sizeof(T)) ? reinterpret_cast<T const *>(data.data()) : nullptr;
+	}
+
+	DxilShaderFeatureInfo const * DxilContainerView::FeatureInfo() const
+	{
+		return this->PartAs<DxilShaderFeatureInfo>(DFCC_FeatureInfo);
+	}
+
+	DxilProgramSignature const * DxilContainerView::InputSignature() const
+	{
+		return this->PartAs<DxilProgramSignature>(DFCC_InputSignature);
+	}
+
+	DxilProgramSignature const * DxilContainerView::OutputSignature() const
+	{
+		return this->PartAs<DxilProgramSignature>(DFCC_OutputSignature);
+	}
+
+	DxilProgramSignature const * DxilContainerView::PatchConstantSignature() const
+	{
+		return this->PartAs<DxilProgramSignature>(DFCC_PatchConstantSignature);
+	}
+
+	DxilProgramHeader const * DxilContainerView::Program() const
+	{
+		auto part = this->FindPart(DFCC_ShaderDebugInfoDXIL);
+		if (!part)
+		{
+			part = this->FindPart(DFCC_DXIL);
+		}
+		if (!part)
+		{
+			return nullptr;
+		}
+
+		auto program_header = reinterpret_cast<DxilProgramHeader const *>(GetDxilPartData(part));
+		return IsValidDxilProgramHeader(program_header, part->PartSize) ? program_header : nullptr;
+	}
+
+	uint32_t DxilContainerView::KnownPartIndex(uint32_t four_cc)
+	{
+		switch (four_cc)
+		{
+		case DFCC_ResourceDef:
+			return 0;
+		case DFCC_InputSignature:
+			return 1;
+		case DFCC_OutputSignature:
+			return 2;
+		case DFCC_PatchConstantSignature:
+			return 3;
+		case DFCC_ShaderStatistics:
+			return 4;
+		case DFCC_ShaderDebugInfoDXIL:
+			return 5;
+		case DFCC_FeatureInfo:
+			return 6;
+		case DFCC_PrivateData:
+			return 7;
+		case DFCC_RootSignature:
+			return 8;
+		case DFCC_DXIL:
+			return 9;
+		case DFCC_PipelineStateValidation:
+			return 10;
+
+		default:
+			return NUM_KNOWN_PARTS;
+		}
+	}
+
+	DxilContainerFileView::DxilContainerFileView(std::string const & file_name)
+		: file_(std::make_shared<MappedFile>(file_name)), container_(nullptr, 0)
+	{
+		if (file_->Size() > DxilContainerMaxSize)
+		{
+			TERROR("The shader file is too large.");
+		}
+
+		uint32_t const size = this->Size();
+		if (IsDxilContainerLike(this->Data(), size))
+		{
+			container_ = DxilContainerView(this->Data(), size);
+			program_ = container_.Program();
+		}
+		else
+		{
+			auto program_header = reinterpret_cast<DxilProgramHeader const *>(this->Data());
+			if (IsValidDxilProgramHeader(program_header, size))
+			{
+				program_ = program_header;
+			}
+		}
+	}
+
+	uint8_t const * DxilContainerFileView::Data() const
+	{
+		return file_->Data();
+	}
+
+	uint32_t DxilContainerFileView::Size() const
+	{
+		return static_cast<uint32_t>(file_->Size());
+	}
+
+	std::unique_ptr<LLVMModule> DxilContainerFileView::LoadModule(std::string const & name, LoadMode mode) const
+	{
+		uint8_t const * bitcode = nullptr;
+		uint32_t bitcode_length = 0;
+		if (program_)
+		{
+			GetDxilProgramBitcode(program_, &bitcode, &bitcode_length);
+		}
+		else if (!IsDxilContainerLike(this->Data(), this->Size()))
+		{
+			bitcode = this->Data();
+			bitcode_length = this->Size();
+		}
+		else
+		{
+			TERROR("This container doesn't have a valid DXIL program.");
+		}
+
+		if (mode == LoadMode::Full)
+		{
+			file_->WillNeed(bitcode - this->Data(), bitcode_length);
+		}
+		return LoadLLVMModule(BitcodeSource(file_, bitcode, bitcode_length), name,
+			LoadOptions{ mode, nullptr, DxilMDHelper::ContextPrelude() });
+	}
 }
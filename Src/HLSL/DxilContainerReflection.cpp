@@ -0,0 +1,141 @@
+/**
+ * @file DxilContainerReflection.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of Dilithium
+ * For the latest info, see https://github.com/gongminmin/Dilithium
+ *
+ * @section LICENSE
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Minmin Gong. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <Dilithium/dxc/HLSL/DxilContainerReflection.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Dilithium
+{
+	DxilSignatureView::DxilSignatureView(ArrayRef<uint8_t> part)
+	{
+		if (part.size() < sizeof(DxilProgramSignature))
+		{
+			return;
+		}
+
+		auto signature = reinterpret_cast<DxilProgramSignature const *>(part.data());
+		uint64_t const elements_end = static_cast<uint64_t>(signature->ParamOffset)
+			+ static_cast<uint64_t>(signature->ParamCount) * sizeof(DxilProgramSignatureElement);
+		if ((signature->ParamCount != 0) && (elements_end > part.size()))
+		{
+			return;
+		}
+
+		part_ = part;
+		signature_ = signature;
+		elements_ = reinterpret_cast<DxilProgramSignatureElement const *>(part.data() + signature->ParamOffset);
+	}
+
+	std::string_view DxilSignatureView::SemanticName(DxilProgramSignatureElement const & element) const
+	{
+		uint32_t const offset = element.SemanticName;
+		if (offset >= part_.size())
+		{
+			return std::string_view();
+		}
+
+		auto name = reinterpret_cast<char const *>(part_.data() + offset);
+		size_t const max_length = part_.size() - offset;
+		auto terminator = static_cast<char const *>(std::memchr(name, '\0', max_length));
+		return std::string_view(name, terminator ? terminator - name : max_length);
+	}
+
+	bool DxilSignatureView::HasStreams() const
+	{
+		return std::any_of(this->begin(), this->end(),
+			[](DxilProgramSignatureElement const & element) { return element.Stream != 0; });
+	}
+
+
+	DxilContainerReflection::DxilContainerReflection(DxilContainerView const & container)
+		: container_(container), program_(container.Program())
+	{
+	}
+
+	ShaderKind DxilContainerReflection::GetShaderKind() const
+	{
+		return program_ ? GetVersionShaderType(program_->ProgramVersion) : ShaderKind::Invalid;
+	}
+
+	uint32_t DxilContainerReflection::ShaderModelMajor() const
+	{
+		return program_ ? ((program_->ProgramVersion >> 4) & 0xF) : 0;
+	}
+
+	uint32_t DxilContainerReflection::ShaderModelMinor() const
+	{
+		return program_ ? (program_->ProgramVersion & 0xF) : 0;
+	}
+
+	uint64_t DxilContainerReflection::FeatureFlags() const
+	{
+		auto feature_info = container_.FeatureInfo();
+		return feature_info ? feature_info->FeatureFlags : 0;
+	}
+
+	DxilSignatureView DxilContainerReflection::InputSignature() const
+	{
+		return DxilSignatureView(container_.PartData(DFCC_InputSignature));
+	}
+
+	DxilSignatureView DxilContainerReflection::OutputSignature() const
+	{
+		return DxilSignatureView(container_.PartData(DFCC_OutputSignature));
+	}
+
+	DxilSignatureView DxilContainerReflection::PatchConstantSignature() const
+	{
+		return DxilSignatureView(container_.PartData(DFCC_PatchConstantSignature));
+	}
+
+	PSVRuntimeInfo0 const * DxilContainerReflection::RuntimeInfo() const
+	{
+		// The runtime info is preceded by its size, which grows with the version of the part.
+		auto data = container_.PartData(DFCC_PipelineStateValidation);
+		if (data.size() < sizeof(uint32_t))
+		{
+			return nullptr;
+		}
+		uint32_t info_size;
+		std::memcpy(&info_size, data.data(), sizeof(info_size));
+		if ((info_size < sizeof(PSVRuntimeInfo0)) || (info_size > data.size() - sizeof(uint32_t)))
+		{
+			return nullptr;
+		}
+		return reinterpret_cast<PSVRuntimeInfo0 const *>(data.data() + sizeof(uint32_t));
+	}
+}
@@ -33,7 +33,9 @@
  */
 
 #include <Dilithium/Dilithium.hpp>
+#include <Dilithium/Attributes.hpp>
 #include <Dilithium/Constants.hpp>
+#include <Dilithium/LLVMContext.hpp>
 #include <Dilithium/LLVMModule.hpp>
 #include <Dilithium/Type.hpp>
 #include <Dilithium/DerivedType.hpp>
@@ -61,6 +63,33 @@ namespace Dilithium
 		return tuple_md;
 	}
 
+	std::shared_ptr<LLVMContextPrelude const> const & DxilMDHelper::ContextPrelude()
+	{
+		static std::shared_ptr<LLVMContextPrelude const> const prelude = std::make_shared<LLVMContextPrelude>(
+			[](LLVMContext& context)
+			{
+				context.MdKindId("dx.precise");
+				context.MdKindId("dx.controlflow.hints");
+
+				// The attribute groups of dx.op functions
+				Attribute::AttrKind const nounwind[] = { Attribute::AK_NoUnwind };
+				Attribute::AttrKind const nounwind_readnone[] = { Attribute::AK_NoUnwind, Attribute::AK_ReadNone };
+				Attribute::AttrKind const nounwind_readonly[] = { Attribute::AK_NoUnwind, Attribute::AK_ReadOnly };
+				Attribute::AttrKind const nounwind_noduplicate[] = { Attribute::AK_NoUnwind, Attribute::AK_NoDuplicate };
+				AttributeSet::Get(context, AttributeSet::AI_FunctionIndex, nounwind);
+				AttributeSet::Get(context, AttributeSet::AI_FunctionIndex, nounwind_readnone);
+				AttributeSet::Get(context, AttributeSet::AI_FunctionIndex, nounwind_readonly);
+				AttributeSet::Get(context, AttributeSet::AI_FunctionIndex, nounwind_noduplicate);
+
+				// Shader kinds in dx.shaderModel
+				for (auto kind : { "ps", "vs", "gs", "hs", "ds", "cs" })
+				{
+					MDString::Get(context, kind);
+				}
+			});
+		return prelude;
+	}
+
 	DxilMDHelper::ExtraPropertyHelper::ExtraPropertyHelper(LLVMModule* mod)
 		: context_(mod->Context()), module_(mod)
 	{
@@ -396,39 +425,49 @@ namespace Dilithium
 		uint32_t& active_stream_mask, PrimitiveTopology& stream_primitive_topology,
 		uint32_t& gs_instance_count)
 	{
-		DILITHIUM_UNUSED(mdn);
-		DILITHIUM_UNUSED(primitive);
-		DILITHIUM_UNUSED(max_vertex_count);
-		DILITHIUM_UNUSED(active_stream_mask);
-		DILITHIUM_UNUSED(stream_primitive_topology);
-		DILITHIUM_UNUSED(gs_instance_count);
+		TIFBOOL(mdn.Get() != nullptr);
+		MDTuple const * tuple_md = dyn_cast<MDTuple>(mdn.Get());
+		TIFBOOL(tuple_md != nullptr);
+		TIFBOOL(tuple_md->NumOperands() == DxilGSStateNumFields);
 
-		DILITHIUM_NOT_IMPLEMENTED;
+		primitive = static_cast<InputPrimitive>(ConstMDToUInt32(tuple_md->Operand(DxilGSStateInputPrimitive)));
+		max_vertex_count = ConstMDToUInt32(tuple_md->Operand(DxilGSStateMaxVertexCount));
+		active_stream_mask = ConstMDToUInt32(tuple_md->Operand(DxilGSStateActiveStreamMask));
+		stream_primitive_topology
+			= static_cast<PrimitiveTopology>(ConstMDToUInt32(tuple_md->Operand(DxilGSStateOutputStreamTopology)));
+		gs_instance_count = ConstMDToUInt32(tuple_md->Operand(DxilGSStateGSInstanceCount));
 	}
 
 	void DxilMDHelper::LoadDxilDSState(MDOperand const & mdn, TessellatorDomain& domain, uint32_t& input_control_point_count)
 	{
-		DILITHIUM_UNUSED(mdn);
-		DILITHIUM_UNUSED(domain);
-		DILITHIUM_UNUSED(input_control_point_count);
+		TIFBOOL(mdn.Get() != nullptr);
+		MDTuple const * tuple_md = dyn_cast<MDTuple>(mdn.Get());
+		TIFBOOL(tuple_md != nullptr);
+		TIFBOOL(tuple_md->NumOperands() == DxilDSStateNumFields);
 
-		DILITHIUM_NOT_IMPLEMENTED;
+		domain = static_cast<TessellatorDomain>(ConstMDToUInt32(tuple_md->Operand(DxilDSStateTessellatorDomain)));
+		input_control_point_count = ConstMDToUInt32(tuple_md->Operand(DxilDSStateInputControlPointCount));
 	}
 
 	void DxilMDHelper::LoadDxilHSState(MDOperand const & mdn, Function*& patch_constant_function, uint32_t& input_control_point_count,
 		uint32_t& output_control_point_count, TessellatorDomain& tess_domain, TessellatorPartitioning& tess_partitioning,
 		TessellatorOutputPrimitive& tess_output_primitive, float& max_tess_factor)
 	{
-		DILITHIUM_UNUSED(mdn);
-		DILITHIUM_UNUSED(patch_constant_function);
-		DILITHIUM_UNUSED(input_control_point_count);
-		DILITHIUM_UNUSED(output_control_point_count);
-		DILITHIUM_UNUSED(tess_domain);
-		DILITHIUM_UNUSED(tess_partitioning);
-		DILITHIUM_UNUSED(tess_output_primitive);
-		DILITHIUM_UNUSED(max_tess_factor);
+		TIFBOOL(mdn.Get() != nullptr);
+		MDTuple const * tuple_md = dyn_cast<MDTuple>(mdn.Get());
+		TIFBOOL(tuple_md != nullptr);
+		TIFBOOL(tuple_md->NumOperands() == DxilHSStateNumFields);
 
-		DILITHIUM_NOT_IMPLEMENTED;
+		patch_constant_function
+			= dyn_cast<Function>(ValueMDToValue(tuple_md->Operand(DxilHSStatePatchConstantFunction)));
+		input_control_point_count = ConstMDToUInt32(tuple_md->Operand(DxilHSStateInputControlPointCount));
+		output_control_point_count = ConstMDToUInt32(tuple_md->Operand(DxilHSStateOutputControlPointCount));
+		tess_domain = static_cast<TessellatorDomain>(ConstMDToUInt32(tuple_md->Operand(DxilHSStateTessellatorDomain)));
+		tess_partitioning = static_cast<TessellatorPartitioning>(
+			ConstMDToUInt32(tuple_md->Operand(DxilHSStateTessellatorPartitioning)));
+		tess_output_primitive = static_cast<TessellatorOutputPrimitive>(
+			ConstMDToUInt32(tuple_md->Operand(DxilHSStateTessellatorOutputPrimitive)));
+		max_tess_factor = ConstMDToFloat(tuple_md->Operand(DxilHSStateMaxTessellationFactor));
 	}
 
 	int32_t DxilMDHelper::ConstMDToInt32(MDOperand const & operand)
@@ -473,6 +512,13 @@ namespace Dilithium
 		return ci->ZExtValue() != 0;
 	}
 
+	float DxilMDHelper::ConstMDToFloat(MDOperand const & operand)
+	{
+		ConstantFP* cf = dyn_cast<ConstantFP>(cast<ConstantAsMetadata>(operand)->GetValue());
+		TIFBOOL((cf != nullptr) && cf->GetType()->IsFloatType());
+		return cf->ValueMPF().ConvertToFloat();
+	}
+
 	std::string DxilMDHelper::StringMDToString(MDOperand const & operand)
 	{
 		MDString* md_string = dyn_cast<MDString>(operand.Get());
@@ -509,30 +555,61 @@ namespace Dilithium
 
 	void DxilExtraPropertyHelper::LoadSRVProperties(MDOperand const & operand, DxilResource& srv)
 	{
-		DILITHIUM_UNUSED(operand);
-		DILITHIUM_UNUSED(srv);
-		DILITHIUM_NOT_IMPLEMENTED;
+		LoadResourceProperties(operand, srv);
 	}
 
 	void DxilExtraPropertyHelper::LoadUAVProperties(MDOperand const & operand, DxilResource& uav)
 	{
-		DILITHIUM_UNUSED(operand);
-		DILITHIUM_UNUSED(uav);
-		DILITHIUM_NOT_IMPLEMENTED;
+		LoadResourceProperties(operand, uav);
 	}
 
 	void DxilExtraPropertyHelper::LoadCBufferProperties(MDOperand const & operand, DxilCBuffer& cb)
 	{
+		// DXIL doesn't define extended properties for CBuffers.
 		DILITHIUM_UNUSED(operand);
 		DILITHIUM_UNUSED(cb);
-		DILITHIUM_NOT_IMPLEMENTED;
 	}
 
 	void DxilExtraPropertyHelper::LoadSamplerProperties(MDOperand const & operand, DxilSampler& sampler)
 	{
+		// DXIL doesn't define extended properties for samplers.
 		DILITHIUM_UNUSED(operand);
 		DILITHIUM_UNUSED(sampler);
-		DILITHIUM_NOT_IMPLEMENTED;
+	}
+
+	void DxilExtraPropertyHelper::LoadResourceProperties(MDOperand const & operand, DxilResource& res)
+	{
+		res.SetElementStride(res.IsRawBuffer() ? 1 : 4);
+		res.SetCompType(DxilCompType());
+
+		if (operand.Get() == nullptr)
+		{
+			return;
+		}
+
+		MDTuple const * tuple_md = dyn_cast<MDTuple>(operand.Get());
+		TIFBOOL(tuple_md != nullptr);
+		TIFBOOL((tuple_md->NumOperands() & 0x1) == 0);
+
+		for (uint32_t i = 0; i < tuple_md->NumOperands(); i += 2)
+		{
+			uint32_t tag = DxilMDHelper::ConstMDToUInt32(tuple_md->Operand(i));
+			MDOperand const & mdn = tuple_md->Operand(i + 1);
+			switch (tag)
+			{
+			case DxilMDHelper::DxilTypedBufferElementTypeTag:
+				TIFBOOL(!res.IsStructuredBuffer() && !res.IsRawBuffer());
+				res.SetCompType(DxilCompType(DxilMDHelper::ConstMDToUInt32(mdn)));
+				break;
+			case DxilMDHelper::DxilStructuredBufferElementStrideTag:
+				TIFBOOL(res.IsStructuredBuffer());
+				res.SetElementStride(DxilMDHelper::ConstMDToUInt32(mdn));
+				break;
+
+			default:
+				TERROR("Unknown resource record tag");
+			}
+		}
 	}
 
 	void DxilExtraPropertyHelper::LoadSignatureElementProperties(MDOperand const & operand, DxilSignatureElement& se)
@@ -41,7 +41,6 @@
 #include <Dilithium/dxc/HLSL/DxilResource.hpp>
 #include <Dilithium/dxc/HLSL/DxilSampler.hpp>
 #include <Dilithium/dxc/HLSL/DxilShaderModel.hpp>
-#include <Dilithium/dxc/HLSL/DxilTypeSystem.hpp>
 
 namespace Dilithium
 {
@@ -167,8 +166,17 @@ namespace Dilithium
 
 	DxilModule::DxilModule(LLVMModule* mod)
 		: context_(mod->Context()), module_(mod),
+			entry_func_(nullptr), patch_constant_func_(nullptr),
+			signatures_md_(nullptr), resources_md_(nullptr), properties_md_(nullptr), loaded_sections_(MS_All),
+			loading_sections_(0),
 			md_helper_(std::make_unique<DxilMDHelper>(mod, std::make_unique<DxilExtraPropertyHelper>(mod))),
-			sm_(nullptr)
+			sm_(nullptr), dxil_major_(0), dxil_minor_(0),
+			num_threads_(),
+			input_primitive_(InputPrimitive::Undefined), max_vertex_count_(0), active_stream_mask_(0),
+			stream_primitive_topology_(PrimitiveTopology::Undefined), num_gs_instances_(0),
+			tessellator_domain_(TessellatorDomain::Undefined), input_control_point_count_(0),
+			output_control_point_count_(0), tessellator_partitioning_(TessellatorPartitioning::Undefined),
+			tessellator_output_primitive_(TessellatorOutputPrimitive::Undefined), max_tessellation_factor_(0)
 	{
 		BOOST_ASSERT(mod != nullptr);
 	}
@@ -197,20 +205,77 @@ namespace Dilithium
 		auto entries = md_helper_->GetDxilEntryPoints();
 		TIFBOOL(entries->NumOperands() == 1);
 
-		MDOperand const * signatures;
-		MDOperand const * resources;
-		MDOperand const * properties;
-		md_helper_->GetDxilEntryPoint(entries->Operand(0), entry_func_, entry_name_, signatures, resources, properties);
+		md_helper_->GetDxilEntryPoint(entries->Operand(0), entry_func_, entry_name_, signatures_md_, resources_md_,
+			properties_md_);
+		loaded_sections_ = 0;
+	}
+
+	void DxilModule::LoadMissingSections(uint32_t sections)
+	{
+		BOOST_ASSERT_MSG(sm_ != nullptr, "The metadata has to be loaded first");
 
-		md_helper_->LoadDxilSignatures(*signatures, *input_signature_,
-			*output_signature_, *patch_constant_signature_);
+		loading_sections_ |= sections;
+		try
+		{
+			if (sections & MS_Signatures)
+			{
+				md_helper_->LoadDxilSignatures(*signatures_md_, *input_signature_,
+					*output_signature_, *patch_constant_signature_);
+				loaded_sections_ |= MS_Signatures;
+			}
+			if (sections & MS_Resources)
+			{
+				this->LoadDxilResources(*resources_md_, sections);
+				loaded_sections_ |= sections & MS_Resources;
+			}
+			if (sections & MS_ShaderProperties)
+			{
+				this->LoadDxilShaderProperties(*properties_md_);
+				loaded_sections_ |= MS_ShaderProperties;
+			}
+		}
+		catch (...)
+		{
+			loading_sections_ &= ~sections;
+			this->ResetSections(sections & ~loaded_sections_);
+			throw;
+		}
+		loading_sections_ &= ~sections;
+	}
 
-		this->LoadDxilResources(*resources);
-		this->LoadDxilShaderProperties(*properties);
-		md_helper_->LoadDxilTypeSystem(*type_system_);
+	void DxilModule::ResetSections(uint32_t sections)
+	{
+		if (sections & MS_Signatures)
+		{
+			auto shader_kind = sm_->GetKind();
+			input_signature_ = std::make_unique<DxilSignature>(shader_kind, SignatureKind::Input);
+			output_signature_ = std::make_unique<DxilSignature>(shader_kind, SignatureKind::Output);
+			patch_constant_signature_ = std::make_unique<DxilSignature>(shader_kind, SignatureKind::PatchConstant);
+		}
+		if (sections & MS_SRVs)
+		{
+			srvs_.clear();
+		}
+		if (sections & MS_UAVs)
+		{
+			uavs_.clear();
+		}
+		if (sections & MS_CBuffers)
+		{
+			cbuffers_.clear();
+		}
+		if (sections & MS_Samplers)
+		{
+			samplers_.clear();
+		}
+		if (sections & MS_ShaderProperties)
+		{
+			// The scalar state is overwritten when the section is loaded again.
+			root_signature_ = std::make_unique<DxilRootSignatureHandle>();
+		}
 	}
 
-	void DxilModule::LoadDxilResources(MDOperand const & operand)
+	void DxilModule::LoadDxilResources(MDOperand const & operand, uint32_t sections)
 	{
 		if (operand.Get() == nullptr)
 		{
@@ -223,7 +288,7 @@ namespace Dilithium
 		MDTuple const * samplers;
 		md_helper_->GetDxilResources(operand, srvs, uavs, cbuffers, samplers);
 
-		if (srvs != nullptr)
+		if ((sections & MS_SRVs) && (srvs != nullptr))
 		{
 			for (uint32_t i = 0; i < srvs->NumOperands(); ++ i)
 			{
@@ -233,7 +298,7 @@ namespace Dilithium
 			}
 		}
 
-		if (uavs != nullptr)
+		if ((sections & MS_UAVs) && (uavs != nullptr))
 		{
 			for (uint32_t i = 0; i < uavs->NumOperands(); ++ i)
 			{
@@ -243,7 +308,7 @@ namespace Dilithium
 			}
 		}
 
-		if (cbuffers != nullptr)
+		if ((sections & MS_CBuffers) && (cbuffers != nullptr))
 		{
 			for (uint32_t i = 0; i < cbuffers->NumOperands(); ++ i)
 			{
@@ -253,7 +318,7 @@ namespace Dilithium
 			}
 		}
 
-		if (samplers != nullptr)
+		if ((sections & MS_Samplers) && (samplers != nullptr))
 		{
 			for (uint32_t i = 0; i < samplers->NumOperands(); ++ i)
 			{
@@ -333,21 +398,25 @@ namespace Dilithium
 
 	uint32_t DxilModule::AddCBuffer(std::unique_ptr<DxilCBuffer> cb)
 	{
+		this->LoadSections(MS_CBuffers);
 		return this->AddResource<DxilCBuffer>(cbuffers_, std::move(cb));
 	}
 
 	uint32_t DxilModule::AddSampler(std::unique_ptr<DxilSampler> sampler)
 	{
+		this->LoadSections(MS_Samplers);
 		return this->AddResource<DxilSampler>(samplers_, std::move(sampler));
 	}
 
 	uint32_t DxilModule::AddSRV(std::unique_ptr<DxilResource> srv)
 	{
+		this->LoadSections(MS_SRVs);
 		return this->AddResource<DxilResource>(srvs_, std::move(srv));
 	}
 
 	uint32_t DxilModule::AddUAV(std::unique_ptr<DxilResource> uav)
 	{
+		this->LoadSections(MS_UAVs);
 		return this->AddResource<DxilResource>(uavs_, std::move(uav));
 	}
 }
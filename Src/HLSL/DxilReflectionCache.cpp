@@ -0,0 +1,376 @@
+/**
+ * @file DxilReflectionCache.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of Dilithium
+ * For the latest info, see https://github.com/gongminmin/Dilithium
+ *
+ * @section LICENSE
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Minmin Gong. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <Dilithium/dxc/HLSL/DxilReflectionCache.hpp>
+#include <Dilithium/ErrorHandling.hpp>
+#include <Dilithium/LLVMModule.hpp>
+#include <Dilithium/MappedFile.hpp>
+#include <Dilithium/dxc/HLSL/DxilCBuffer.hpp>
+#include <Dilithium/dxc/HLSL/DxilModule.hpp>
+#include <Dilithium/dxc/HLSL/DxilResource.hpp>
+#include <Dilithium/dxc/HLSL/DxilSampler.hpp>
+#include <Dilithium/dxc/HLSL/DxilShaderModel.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+	using namespace Dilithium;
+
+	template <typename T>
+	void AddResources(std::vector<std::unique_ptr<T>> const & resources, std::vector<DxilReflectionResource>& records,
+		std::string& names)
+	{
+		for (auto const & res : resources)
+		{
+			DxilReflectionResource rec;
+			rec.Class = static_cast<uint8_t>(res->GetClass());
+			rec.Kind = static_cast<uint8_t>(res->GetKind());
+			rec.Pad = 0;
+			rec.ID = res->GetID();
+			rec.Space = res->GetSpaceID();
+			rec.LowerBound = res->GetLowerBound();
+			rec.RangeSize = res->GetRangeSize();
+			rec.Name = static_cast<uint32_t>(names.size());	// Relative to the names until they are placed
+			records.push_back(rec);
+
+			names += res->GetGlobalName();
+			names.push_back('\0');
+		}
+	}
+
+	bool IsHashed(DxilContainerHash const & hash)
+	{
+		return std::any_of(std::begin(hash.Digest), std::end(hash.Digest), [](uint8_t digit) { return digit != 0; });
+	}
+}
+
+namespace Dilithium
+{
+	DxilReflectionRecord::DxilReflectionRecord(DxilContainerView const & container, DxilModule const & module)
+	{
+		BOOST_ASSERT(container.Valid());
+		BOOST_ASSERT_MSG(module.GetShaderModel() != nullptr, "The metadata of the module has to be loaded");
+
+		DxilReflectionRecordHeader header;
+		std::memset(&header, 0, sizeof(header));
+		header.HeaderFourCC = DxilReflectionRecordFourCC;
+		header.Version = DxilReflectionRecordVersion;
+		header.Hash = container.Header()->Hash;
+
+		auto sm = module.GetShaderModel();
+		header.ShaderKind = static_cast<uint8_t>(sm->GetKind());
+		header.ShaderModelMajor = static_cast<uint8_t>(sm->GetMajor());
+		header.ShaderModelMinor = static_cast<uint8_t>(sm->GetMinor());
+		header.ShaderFlags = module.GetShaderFlags().GetShaderFlagsRaw();
+
+		for (uint32_t i = 0; i < 3; ++ i)
+		{
+			header.NumThreads[i] = module.GetNumThreads(i);
+		}
+
+		header.InputPrimitive = static_cast<uint32_t>(module.GetInputPrimitive());
+		header.MaxVertexCount = module.GetMaxVertexCount();
+		header.ActiveStreamMask = module.GetActiveStreamMask();
+		header.StreamPrimitiveTopology = static_cast<uint32_t>(module.GetStreamPrimitiveTopology());
+		header.GSInstanceCount = module.GetGSInstanceCount();
+
+		header.TessellatorDomain = static_cast<uint32_t>(module.GetTessellatorDomain());
+		header.InputControlPointCount = module.GetInputControlPointCount();
+		header.OutputControlPointCount = module.GetOutputControlPointCount();
+		header.TessellatorPartitioning = static_cast<uint32_t>(module.GetTessellatorPartitioning());
+		header.TessellatorOutputPrimitive = static_cast<uint32_t>(module.GetTessellatorOutputPrimitive());
+		header.MaxTessellationFactor = module.GetMaxTessellationFactor();
+
+		auto buffer = std::make_shared<std::vector<uint8_t>>(sizeof(header));
+		auto append = [&buffer](DxilReflectionBlob& blob, void const * data, size_t size)
+		{
+			blob.Offset = static_cast<uint32_t>(buffer->size());
+			blob.Size = static_cast<uint32_t>(size);
+			auto bytes = static_cast<uint8_t const *>(data);
+			buffer->insert(buffer->end(), bytes, bytes + size);
+		};
+
+		// The signature parts are self-contained, so they are copied as they are and read back with DxilSignatureView.
+		auto input_signature = container.PartData(DFCC_InputSignature);
+		append(header.InputSignature, input_signature.data(), input_signature.size());
+		auto output_signature = container.PartData(DFCC_OutputSignature);
+		append(header.OutputSignature, output_signature.data(), output_signature.size());
+		auto patch_constant_signature = container.PartData(DFCC_PatchConstantSignature);
+		append(header.PatchConstantSignature, patch_constant_signature.data(), patch_constant_signature.size());
+
+		std::vector<DxilReflectionResource> resources;
+		std::string names;
+		AddResources(module.GetSRVs(), resources, names);
+		AddResources(module.GetUAVs(), resources, names);
+		AddResources(module.GetCBuffers(), resources, names);
+		AddResources(module.GetSamplers(), resources, names);
+		uint32_t const names_offset = static_cast<uint32_t>(buffer->size() + resources.size() * sizeof(resources[0]));
+		for (auto& res : resources)
+		{
+			res.Name += names_offset;
+		}
+		append(header.Resources, resources.data(), resources.size() * sizeof(resources[0]));
+		buffer->insert(buffer->end(), names.begin(), names.end());
+
+		auto root_signature = module.GetRootSignature();
+		if ((root_signature != nullptr) && !root_signature->IsEmpty())
+		{
+			append(header.RootSignature, root_signature->GetSerializedBytes(), root_signature->GetSerializedSize());
+		}
+		else
+		{
+			header.RootSignature.Offset = static_cast<uint32_t>(buffer->size());
+		}
+
+		header.SizeInBytes = static_cast<uint32_t>(buffer->size());
+		std::memcpy(buffer->data(), &header, sizeof(header));
+
+		data_ = ArrayRef<uint8_t>(buffer->data(), buffer->size());
+		storage_ = std::move(buffer);
+		this->Validate();
+	}
+
+	DxilReflectionRecord::DxilReflectionRecord(std::shared_ptr<MappedFile> const & file)
+		: storage_(file), data_(file->Data(), static_cast<size_t>(file->Size()))
+	{
+		this->Validate();
+	}
+
+	DxilSignatureView DxilReflectionRecord::InputSignature() const
+	{
+		return header_ ? DxilSignatureView(this->Blob(header_->InputSignature)) : DxilSignatureView();
+	}
+
+	DxilSignatureView DxilReflectionRecord::OutputSignature() const
+	{
+		return header_ ? DxilSignatureView(this->Blob(header_->OutputSignature)) : DxilSignatureView();
+	}
+
+	DxilSignatureView DxilReflectionRecord::PatchConstantSignature() const
+	{
+		return header_ ? DxilSignatureView(this->Blob(header_->PatchConstantSignature)) : DxilSignatureView();
+	}
+
+	ArrayRef<DxilReflectionResource> DxilReflectionRecord::Resources() const
+	{
+		if (!header_)
+		{
+			return ArrayRef<DxilReflectionResource>();
+		}
+
+		auto blob = this->Blob(header_->Resources);
+		return ArrayRef<DxilReflectionResource>(reinterpret_cast<DxilReflectionResource const *>(blob.data()),
+			blob.size() / sizeof(DxilReflectionResource));
+	}
+
+	std::string_view DxilReflectionRecord::ResourceName(DxilReflectionResource const & res) const
+	{
+		uint32_t const offset = res.Name;
+		if (offset >= data_.size())
+		{
+			return std::string_view();
+		}
+
+		auto name = reinterpret_cast<char const *>(data_.data() + offset);
+		size_t const max_length = data_.size() - offset;
+		auto terminator = static_cast<char const *>(std::memchr(name, '\0', max_length));
+		return std::string_view(name, terminator ? terminator - name : max_length);
+	}
+
+	ArrayRef<uint8_t> DxilReflectionRecord::RootSignature() const
+	{
+		return header_ ? this->Blob(header_->RootSignature) : ArrayRef<uint8_t>();
+	}
+
+	void DxilReflectionRecord::Validate()
+	{
+		if (data_.size() < sizeof(DxilReflectionRecordHeader))
+		{
+			return;
+		}
+
+		auto header = reinterpret_cast<DxilReflectionRecordHeader const *>(data_.data());
+		if ((header->HeaderFourCC != DxilReflectionRecordFourCC) || (header->Version != DxilReflectionRecordVersion)
+			|| (header->SizeInBytes != data_.size()))
+		{
+			return;
+		}
+
+		DxilReflectionBlob const * blobs[] = { &header->InputSignature, &header->OutputSignature,
+			&header->PatchConstantSignature, &header->Resources, &header->RootSignature };
+		for (auto blob : blobs)
+		{
+			if (static_cast<uint64_t>(blob->Offset) + blob->Size > data_.size())
+			{
+				return;
+			}
+		}
+		if (header->Resources.Size % sizeof(DxilReflectionResource) != 0)
+		{
+			return;
+		}
+
+		header_ = header;
+	}
+
+	ArrayRef<uint8_t> DxilReflectionRecord::Blob(DxilReflectionBlob const & blob) const
+	{
+		return data_.Slice(blob.Offset, blob.Size);
+	}
+
+
+	DxilReflectionCache::DxilReflectionCache(std::string const & dir)
+		: dir_(dir)
+	{
+#ifdef _WIN32
+		::CreateDirectoryA(dir_.c_str(), nullptr);
+#else
+		::mkdir(dir_.c_str(), 0777);
+#endif
+	}
+
+	DxilReflectionRecord DxilReflectionCache::Find(DxilContainerHash const & hash) const
+	{
+		std::shared_ptr<MappedFile> file;
+		try
+		{
+			file = std::make_shared<MappedFile>(this->FileName(hash), MappedFile::AccessPattern::Normal);
+		}
+		catch (std::exception&)
+		{
+			return DxilReflectionRecord();
+		}
+
+		DxilReflectionRecord record(file);
+		if (!record.Valid() || (std::memcmp(&record.Header()->Hash, &hash, sizeof(hash)) != 0))
+		{
+			return DxilReflectionRecord();
+		}
+		return record;
+	}
+
+	void DxilReflectionCache::Store(DxilReflectionRecord const & record) const
+	{
+		BOOST_ASSERT(record.Valid());
+
+		std::string const file_name = this->FileName(record.Header()->Hash);
+		std::string const tmp_name = file_name + "." + std::to_string(std::random_device()()) + ".tmp";
+		{
+			std::ofstream ofs(tmp_name, std::ios_base::binary);
+			if (!ofs)
+			{
+				TERROR(("Couldn't create " + tmp_name).c_str());
+			}
+
+			auto data = record.Data();
+			ofs.write(reinterpret_cast<char const *>(data.data()), data.size());
+			if (!ofs)
+			{
+				ofs.close();
+				std::remove(tmp_name.c_str());
+				TERROR(("Couldn't write " + tmp_name).c_str());
+			}
+		}
+
+		if (std::rename(tmp_name.c_str(), file_name.c_str()) != 0)
+		{
+			// Windows doesn't replace an existing file. Whoever wrote it stored the same record.
+			std::remove(tmp_name.c_str());
+		}
+	}
+
+	DxilReflectionRecord DxilReflectionCache::GetOrCreate(DxilContainerFileView const & file) const
+	{
+		if (!file.Container())
+		{
+			TERROR("This isn't a valid container.");
+		}
+
+		auto const & container = file.ContainerView();
+		auto const & hash = container.Header()->Hash;
+		bool const hashed = IsHashed(hash);
+		if (hashed)
+		{
+			auto record = this->Find(hash);
+			if (record.Valid())
+			{
+				return record;
+			}
+		}
+
+		auto module = file.LoadModule("", DxilContainerFileView::LoadMode::WithoutBodies);
+		DxilReflectionRecord record(container, module->GetOrCreateDxilModule());
+		if (hashed)
+		{
+			try
+			{
+				this->Store(record);
+			}
+			catch (std::exception&)
+			{
+				// The record is still good. A cache that can't be written only costs the next run a decode.
+			}
+		}
+		return record;
+	}
+
+	std::string DxilReflectionCache::FileName(DxilContainerHash const & hash) const
+	{
+		static char const hex_digits[] = "0123456789abcdef";
+
+		std::string name = dir_ + "/";
+		for (auto digit : hash.Digest)
+		{
+			name.push_back(hex_digits[digit >> 4]);
+			name.push_back(hex_digits[digit & 0xF]);
+		}
+		name += ".dlr";
+		return name;
+	}
+}
@@ -39,7 +39,7 @@ namespace Dilithium
 {
 	DxilResource::DxilResource()
 		: DxilResourceBase(ResourceClass::Invalid),
-			sample_count_(0),
+			element_stride_(0), sample_count_(0),
 			globally_coherent_(false), has_counter_(false), rov_(false)
 	{
 	}
@@ -40,27 +40,6 @@
 #include <Dilithium/Value.hpp>
 #include "LLVMContextImpl.hpp"
 
-namespace
-{
-	template <typename T>
-	class UniquePtrEqual
-	{
-	public:
-		explicit UniquePtrEqual(T* ptr)
-			: ptr_(ptr)
-		{
-		}
-
-		bool operator()(std::unique_ptr<T> const & rhs)
-		{
-			return ptr_ == rhs.get();
-		}
-
-	private:
-		T* ptr_;
-	};
-}
-
 namespace Dilithium 
 {
 	Instruction::Instruction(Type* ty, uint32_t type, uint32_t num_ops, uint32_t num_uses, Instruction* insert_before)
@@ -71,9 +50,7 @@ namespace Dilithium
 		{
 			auto bb = insert_before->Parent();
 			BOOST_ASSERT_MSG(bb, "Instruction to insert before is not in a basic block!");
-			auto iter = std::find_if(bb->InstList().begin(), bb->InstList().end(), UniquePtrEqual<Instruction>(insert_before));
-			-- iter;
-			bb->InstList().insert(iter, std::unique_ptr<Instruction>(this));
+			bb->InstList().insert(BasicBlock::iterator(insert_before), this);
 			AddToSymbolTableList(this, bb);
 		}
 	}
@@ -83,7 +60,7 @@ namespace Dilithium
 			parent_(nullptr)
 	{
 		BOOST_ASSERT_MSG(insert_at_end, "Basic block to append to may not be NULL!");
-		insert_at_end->InstList().push_back(std::unique_ptr<Instruction>(this));
+		insert_at_end->InstList().push_back(this);
 		AddToSymbolTableList(this, insert_at_end);
 	}
 
@@ -79,17 +79,17 @@ namespace Dilithium
 
 	ReturnInst* ReturnInst::Create(LLVMContext& context, Value* ret_val, Instruction* insert_before)
 	{
-		return new ReturnInst(context, ret_val, insert_before);
+		return new (context, !!ret_val) ReturnInst(context, ret_val, insert_before);
 	}
 
 	ReturnInst* ReturnInst::Create(LLVMContext& context, Value* ret_val, BasicBlock* insert_at_end)
 	{
-		return new ReturnInst(context, ret_val, insert_at_end);
+		return new (context, !!ret_val) ReturnInst(context, ret_val, insert_at_end);
 	}
 
 	ReturnInst* ReturnInst::Create(LLVMContext& context, BasicBlock* insert_at_end)
 	{
-		return new ReturnInst(context, insert_at_end);
+		return new (context, 0) ReturnInst(context, insert_at_end);
 	}
 
 
@@ -190,22 +190,22 @@ namespace Dilithium
 	CallInst* CallInst::Create(FunctionType* ty, Value* func, ArrayRef<Value*> args, std::string_view name,
 		Instruction* insert_before)
 	{
-		return new CallInst(ty, func, args, name, insert_before);
+		return new (ty->Context(), static_cast<uint32_t>(args.size() + 1)) CallInst(ty, func, args, name, insert_before);
 	}
 
 	CallInst* CallInst::Create(Value* func, ArrayRef<Value*> args, std::string_view name, BasicBlock* insert_at_end)
 	{
-		return new CallInst(func, args, name, insert_at_end);
+		return new (func->Context(), static_cast<uint32_t>(args.size() + 1)) CallInst(func, args, name, insert_at_end);
 	}
 
 	CallInst* CallInst::Create(Value* func, std::string_view name, Instruction* insert_before)
 	{
-		return new CallInst(func, name, insert_before);
+		return new (func->Context(), 1) CallInst(func, name, insert_before);
 	}
 
 	CallInst* CallInst::Create(Value* func, std::string_view name, BasicBlock* insert_at_end)
 	{
-		return new CallInst(func, name, insert_at_end);
+		return new (func->Context(), 1) CallInst(func, name, insert_at_end);
 	}
 
 	CallInst::TailCallKind CallInst::GetTailCallKind() const
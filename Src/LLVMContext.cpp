@@ -40,8 +40,36 @@
 
 namespace Dilithium
 {
-	LLVMContext::LLVMContext()
+	LLVMContext::LLVMContext(bool use_arena)
 		: impl_(std::make_unique<LLVMContextImpl>(*this))
+	{
+		if (use_arena)
+		{
+			impl_->arena = std::make_unique<Arena>();
+		}
+
+		this->CreateFixedMdKinds();
+	}
+
+	LLVMContext::LLVMContext(std::shared_ptr<LLVMContextPrelude const> const & prelude, bool use_arena)
+		: prelude_(prelude), impl_(std::make_unique<LLVMContextImpl>(*this))
+	{
+		BOOST_ASSERT(prelude_);
+
+		if (use_arena)
+		{
+			impl_->arena = std::make_unique<Arena>();
+		}
+
+		// The fixed metadata kinds come first in the prelude, since it's populated on top of a context of its own.
+		impl_->prelude = &prelude_->Impl();
+	}
+
+	LLVMContext::~LLVMContext()
+	{
+	}
+
+	void LLVMContext::CreateFixedMdKinds()
 	{
 		// Create the fixed metadata kinds. This is done in the same order as the
 		// MD_* enum values so that they correspond.
@@ -103,21 +131,89 @@ namespace Dilithium
 		DILITHIUM_UNUSED(dereferenceable_or_null_id);
 	}
 
-	LLVMContext::~LLVMContext()
+	void* LLVMContext::AllocateObject(size_t size)
+	{
+		// The header holds the arena of the block, or null if it's from the heap.
+		static_assert(sizeof(Arena*) <= Arena::ALIGNMENT, "The header has to keep the object aligned");
+
+		auto arena = impl_->arena.get();
+		void* block = arena ? arena->Allocate(size + Arena::ALIGNMENT) : ::operator new(size + Arena::ALIGNMENT);
+		*static_cast<Arena**>(block) = arena;
+		return static_cast<uint8_t*>(block) + Arena::ALIGNMENT;
+	}
+
+	void LLVMContext::DeallocateObject(void* p, size_t size)
 	{
+		if (p == nullptr)
+		{
+			return;
+		}
+
+		void* block = static_cast<uint8_t*>(p) - Arena::ALIGNMENT;
+		auto arena = *static_cast<Arena**>(block);
+		if (arena)
+		{
+			arena->Deallocate(block, size + Arena::ALIGNMENT);
+		}
+		else
+		{
+			::operator delete(block);
+		}
 	}
 
 	uint32_t LLVMContext::MdKindId(std::string_view name) const
 	{
-		return impl_->custom_md_kind_names.emplace(name, static_cast<uint32_t>(impl_->custom_md_kind_names.size())).first->second;
+		// The kinds of the prelude take the first IDs, the ones of this context follow them.
+		uint32_t first_id = 0;
+		if (impl_->prelude)
+		{
+			auto const & prelude_names = impl_->prelude->custom_md_kind_names;
+			auto iter = prelude_names.find(name);
+			if (iter != prelude_names.end())
+			{
+				return iter->second;
+			}
+			first_id = static_cast<uint32_t>(prelude_names.size());
+		}
+
+		auto& names = impl_->custom_md_kind_names;
+		auto iter = names.find(name);
+		if (iter != names.end())
+		{
+			return iter->second;
+		}
+
+		uint32_t const id = first_id + static_cast<uint32_t>(names.size());
+		impl_->custom_md_kind_name_storage.emplace_back(name);
+		names.emplace(impl_->custom_md_kind_name_storage.back(), id);
+		return id;
 	}
 
 	void LLVMContext::MdKindNames(boost::container::small_vector_base<std::string_view>& names) const
 	{
-		names.resize(impl_->custom_md_kind_names.size());
+		size_t num_names = impl_->custom_md_kind_names.size();
+		if (impl_->prelude)
+		{
+			num_names += impl_->prelude->custom_md_kind_names.size();
+		}
+		names.resize(num_names);
+
+		if (impl_->prelude)
+		{
+			for (auto const & name : impl_->prelude->custom_md_kind_names)
+			{
+				names[name.second] = name.first;
+			}
+		}
 		for (auto iter = impl_->custom_md_kind_names.begin(), end_iter = impl_->custom_md_kind_names.end(); iter != end_iter; ++ iter)
 		{
 			names[iter->second] = iter->first;
 		}
 	}
+
+
+	LLVMContextPrelude::LLVMContextPrelude(std::function<void(LLVMContext& context)> const & populate)
+	{
+		populate(context_);
+	}
 }
@@ -39,7 +39,8 @@
 namespace Dilithium
 {
 	LLVMContextImpl::LLVMContextImpl(LLVMContext& context)
-		: the_true_val(nullptr), the_false_val(nullptr),
+		: prelude(nullptr),
+			the_true_val(nullptr), the_false_val(nullptr),
 			void_ty(context, Type::TID_Void),
 			label_ty(context, Type::TID_Label),
 			half_ty(context, Type::TID_Half),
@@ -57,6 +58,19 @@ namespace Dilithium
 
 	LLVMContextImpl::~LLVMContextImpl()
 	{
+		if (arena)
+		{
+			arena->Release();
+		}
+
+		for (auto& table : small_int_constants)
+		{
+			for (auto c : table)
+			{
+				delete c;
+			}
+			table.clear();
+		}
 		for (auto& v : int_constants)
 		{
 			delete v.second;
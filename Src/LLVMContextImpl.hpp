@@ -35,6 +35,7 @@
 #ifndef _DILITHIUM_LLVM_CONTEXT_IMPL_HPP
 #define _DILITHIUM_LLVM_CONTEXT_IMPL_HPP
 
+#include <Dilithium/Arena.hpp>
 #include <Dilithium/Constants.hpp>
 #include <Dilithium/DerivedType.hpp>
 #include <Dilithium/Instructions.hpp>
@@ -42,12 +43,17 @@
 #include <Dilithium/MPInt.hpp>
 #include <Dilithium/TrackingMDRef.hpp>
 #include "AttributeImpl.hpp"
+#include "UniquingSet.hpp"
 
+#include <cstdint>
+#include <deque>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <boost/container/small_vector.hpp>
+#include <boost/functional/hash.hpp>
 
 namespace Dilithium
 {
@@ -88,19 +94,239 @@ namespace Dilithium
 		boost::container::small_vector<std::pair<uint32_t, TrackingMDNodeRef>, 2> attachments_;
 	};
 
+	struct FunctionTypeKeyInfo
+	{
+		struct KeyTy
+		{
+			Type* return_type;
+			ArrayRef<Type*> params;
+			bool is_var_args;
+
+			KeyTy(Type* r, ArrayRef<Type*> p, bool v)
+				: return_type(r), params(p), is_var_args(v)
+			{
+			}
+		};
+
+		static size_t HashValue(KeyTy const & key)
+		{
+			size_t hash_val = boost::hash_value(key.return_type);
+			boost::hash_combine(hash_val, boost::hash_range(key.params.begin(), key.params.end()));
+			boost::hash_combine(hash_val, key.is_var_args);
+			return hash_val;
+		}
+
+		static bool IsEqual(KeyTy const & key, FunctionType const * ft)
+		{
+			return (key.return_type == ft->ReturnType()) && (key.is_var_args == ft->IsVarArg()) && (key.params == ft->Params());
+		}
+	};
+
+	struct AnonStructTypeKeyInfo
+	{
+		struct KeyTy
+		{
+			ArrayRef<Type*> elements;
+			bool is_packed;
+
+			KeyTy(ArrayRef<Type*> e, bool p)
+				: elements(e), is_packed(p)
+			{
+			}
+		};
+
+		static size_t HashValue(KeyTy const & key)
+		{
+			size_t hash_val = boost::hash_range(key.elements.begin(), key.elements.end());
+			boost::hash_combine(hash_val, key.is_packed);
+			return hash_val;
+		}
+
+		static bool IsEqual(KeyTy const & key, StructType const * st)
+		{
+			return (key.is_packed == st->IsPacked()) && (key.elements == st->elements());
+		}
+	};
+
+	struct AttributeKeyInfo
+	{
+		// A val of 0 stands for an enum attribute
+		struct KeyTy
+		{
+			Attribute::AttrKind kind;
+			uint64_t val;
+
+			KeyTy(Attribute::AttrKind k, uint64_t v)
+				: kind(k), val(v)
+			{
+			}
+		};
+
+		static size_t HashValue(KeyTy const & key)
+		{
+			size_t hash_val = boost::hash_value(key.kind);
+			if (key.val)
+			{
+				boost::hash_combine(hash_val, key.val);
+			}
+			return hash_val;
+		}
+
+		static bool IsEqual(KeyTy const & key, AttributeImpl const * attr)
+		{
+			if (key.val)
+			{
+				return attr->IsIntAttribute() && (attr->KindAsEnum() == key.kind) && (attr->ValueAsInt() == key.val);
+			}
+			else
+			{
+				return attr->IsEnumAttribute() && (attr->KindAsEnum() == key.kind);
+			}
+		}
+	};
+
+	struct AttributeSetNodeKeyInfo
+	{
+		// Sorted
+		typedef ArrayRef<Attribute> KeyTy;
+
+		static size_t HashValue(KeyTy const & key)
+		{
+			size_t hash_val = 0;
+			for (auto const & attr : key)
+			{
+				boost::hash_combine(hash_val, attr.RawPointer());
+			}
+			return hash_val;
+		}
+
+		static bool IsEqual(KeyTy const & key, AttributeSetNode const * node)
+		{
+			return key == ArrayRef<Attribute>(node->begin(), node->end());
+		}
+	};
+
+	struct AttributeSetImplKeyInfo
+	{
+		typedef ArrayRef<AttributeSetImpl::IndexAttrPair> KeyTy;
+
+		static size_t HashValue(KeyTy const & key)
+		{
+			size_t hash_val = 0;
+			for (auto const & attr : key)
+			{
+				boost::hash_combine(hash_val, attr.first);
+				boost::hash_combine(hash_val, attr.second);
+			}
+			return hash_val;
+		}
+
+		static bool IsEqual(KeyTy const & key, AttributeSetImpl const * attrs)
+		{
+			if (key.size() != attrs->NumAttributes())
+			{
+				return false;
+			}
+			for (uint32_t i = 0; i < key.size(); ++ i)
+			{
+				if ((key[i].first != attrs->SlotIndex(i)) || (key[i].second != attrs->SlotNode(i)))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+	};
+
+	struct MDStringKeyInfo
+	{
+		typedef std::string_view KeyTy;
+
+		static size_t HashValue(KeyTy const & key)
+		{
+			return boost::hash_value(key);
+		}
+
+		static bool IsEqual(KeyTy const & key, MDString const * mds)
+		{
+			return key == mds->String();
+		}
+	};
+
+	struct MDStringDeleter
+	{
+		void operator()(MDString* mds) const
+		{
+			MDString::Destroy(mds);
+		}
+	};
+
 	// TODO: Consider merged with LLVMContext
 	struct LLVMContextImpl
 	{
 		explicit LLVMContextImpl(LLVMContext& context);
 		~LLVMContextImpl();
 
+		// Declared first, so it outlives everything else allocated from it.
+		std::unique_ptr<Arena> arena;
+
+		// The shared objects are looked up here before the tables of this context. Never changed through this context.
+		LLVMContextImpl const * prelude;
+
+		// Small values of the common widths are looked up by index, the rest go through int_constants
+		static int64_t constexpr SMALL_INT_MIN = -256;
+		static int64_t constexpr SMALL_INT_MAX = 1023;
+		static uint32_t constexpr NUM_SMALL_INT_WIDTHS = 5;
+
+		static uint32_t SmallIntWidthIndex(uint32_t bit_width)
+		{
+			switch (bit_width)
+			{
+			case 1:
+				return 0;
+			case 8:
+				return 1;
+			case 16:
+				return 2;
+			case 32:
+				return 3;
+			case 64:
+				return 4;
+
+			default:
+				return NUM_SMALL_INT_WIDTHS;
+			}
+		}
+
+		// The table of a width only covers the part of [SMALL_INT_MIN, SMALL_INT_MAX] the width can hold as a signed
+		// value, so i1 has 2 slots and i8 256.
+		static int64_t SmallIntMin(uint32_t bit_width)
+		{
+			if (bit_width < 64)
+			{
+				int64_t const width_min = -(INT64_C(1) << (bit_width - 1));
+				return (width_min > SMALL_INT_MIN) ? width_min : SMALL_INT_MIN;
+			}
+			return SMALL_INT_MIN;
+		}
+		static int64_t SmallIntMax(uint32_t bit_width)
+		{
+			if (bit_width < 64)
+			{
+				int64_t const width_max = (INT64_C(1) << (bit_width - 1)) - 1;
+				return (width_max < SMALL_INT_MAX) ? width_max : SMALL_INT_MAX;
+			}
+			return SMALL_INT_MAX;
+		}
+
+		std::vector<ConstantInt*> small_int_constants[NUM_SMALL_INT_WIDTHS];
 		std::unordered_map<MPInt, ConstantInt*> int_constants;
 
-		std::unordered_map<uint64_t, std::unique_ptr<AttributeImpl>> attrs_set;
-		std::unordered_map<uint64_t, std::unique_ptr<AttributeSetImpl>> attrs_lists;
-		std::unordered_map<uint64_t, std::unique_ptr<AttributeSetNode>> attrs_set_nodes;
+		UniquingSet<AttributeImpl, AttributeKeyInfo> attrs_set;
+		UniquingSet<AttributeSetImpl, AttributeSetImplKeyInfo> attrs_lists;
+		UniquingSet<AttributeSetNode, AttributeSetNodeKeyInfo> attrs_set_nodes;
 
-		std::unordered_map<uint64_t, std::unique_ptr<MDString>> md_string_cache;
+		UniquingSet<MDString, MDStringKeyInfo, MDStringDeleter> md_string_cache;
 		std::unordered_map<Value*, ValueAsMetadata*> values_as_metadata;
 		std::unordered_map<Metadata*, MetadataAsValue*> metadata_as_values;
 
@@ -118,8 +344,8 @@ namespace Dilithium
 		IntegerType int1_ty, int8_ty, int16_ty, int32_ty, int64_ty;
 
 		std::unordered_map<uint32_t, std::unique_ptr<IntegerType>> integer_types;
-		std::unordered_map<uint64_t, std::unique_ptr<FunctionType>> function_types;
-		std::unordered_map<uint64_t, std::unique_ptr<StructType>> anon_struct_types;
+		UniquingSet<FunctionType, FunctionTypeKeyInfo> function_types;
+		UniquingSet<StructType, AnonStructTypeKeyInfo> anon_struct_types;
 		std::unordered_map<std::string, std::unique_ptr<StructType>> named_struct_types;
 		uint32_t named_struct_types_unique_id;
 
@@ -131,8 +357,10 @@ namespace Dilithium
 		// This map keeps track of all of the value handles that are watching a Value*
 		std::unordered_map<Value*, ValueHandleBase*> value_handles;
 
-		// Metadata string to ID mapping
-		std::unordered_map<std::string, uint32_t> custom_md_kind_names;
+		// Metadata string to ID mapping. The keys view the names kept in custom_md_kind_name_storage, so a lookup
+		// doesn't have to build a string.
+		std::unordered_map<std::string_view, uint32_t, boost::hash<std::string_view>> custom_md_kind_names;
+		std::deque<std::string> custom_md_kind_name_storage;
 
 		// Collection of per-instruction metadata used in this context.
 		std::unordered_map<Instruction const *, MDAttachmentMap> instruction_metadata;
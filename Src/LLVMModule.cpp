@@ -37,6 +37,7 @@
 
 #include <Dilithium/GVMaterializer.hpp>
 #include <Dilithium/LLVMContext.hpp>
+#include "LLVMContextImpl.hpp"
 
 #include <Dilithium/dxc/HLSL/DxilModule.hpp>
 
@@ -50,6 +51,16 @@ namespace Dilithium
 	LLVMModule::~LLVMModule()
 	{
 		//this->ResetDxilModule();
+		materializer_.reset();
+		if (context_.use_count() == 1)
+		{
+			// The context goes with the module, so there is nothing to recycle its blocks for.
+			auto& arena = context_->Impl().arena;
+			if (arena)
+			{
+				arena->Release();
+			}
+		}
 		this->DropAllReferences();
 		function_list_.clear();
 		named_md_list_.clear();
@@ -103,6 +114,14 @@ namespace Dilithium
 		materializer_ = gvm;
 	}
 
+	void LLVMModule::Materialize(GlobalValue* gv)
+	{
+		if (materializer_)
+		{
+			materializer_->Materialize(gv);
+		}
+	}
+
 	void LLVMModule::MaterializeAllPermanently()
 	{
 		if (materializer_)
@@ -116,7 +135,7 @@ namespace Dilithium
 	{
 		for (auto& func : *this)
 		{
-			func->DropAllReferences();
+			func.DropAllReferences();
 		}
 	}
 
@@ -0,0 +1,205 @@
+/**
+ * @file MappedFile.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of Dilithium
+ * For the latest info, see https://github.com/gongminmin/Dilithium
+ *
+ * @section LICENSE
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Minmin Gong. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <Dilithium/MappedFile.hpp>
+#include <Dilithium/ErrorHandling.hpp>
+#include <Dilithium/Util.hpp>
+
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Dilithium
+{
+#ifdef _WIN32
+	MappedFile::MappedFile(std::string const & file_name, AccessPattern pattern)
+	{
+		DWORD flags = FILE_ATTRIBUTE_NORMAL;
+		switch (pattern)
+		{
+		case AccessPattern::Sequential:
+			flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+			break;
+		case AccessPattern::Random:
+			flags |= FILE_FLAG_RANDOM_ACCESS;
+			break;
+		default:
+			break;
+		}
+
+		HANDLE file = ::CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			TERROR(("Couldn't open " + file_name).c_str());
+		}
+		file_handle_ = file;
+
+		LARGE_INTEGER size;
+		if (!::GetFileSizeEx(file, &size))
+		{
+			this->Close();
+			TERROR(("Couldn't get the size of " + file_name).c_str());
+		}
+		size_ = static_cast<uint64_t>(size.QuadPart);
+
+		// Empty files can't be mapped.
+		if (size_ > 0)
+		{
+			mapping_handle_ = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping_handle_)
+			{
+				data_ = static_cast<uint8_t const *>(::MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+			}
+			if (!data_)
+			{
+				this->Close();
+				TERROR(("Couldn't map " + file_name).c_str());
+			}
+		}
+	}
+
+	MappedFile::~MappedFile()
+	{
+		this->Close();
+	}
+
+	void MappedFile::Close()
+	{
+		if (data_)
+		{
+			::UnmapViewOfFile(data_);
+			data_ = nullptr;
+		}
+		if (mapping_handle_)
+		{
+			::CloseHandle(mapping_handle_);
+			mapping_handle_ = nullptr;
+		}
+		if (file_handle_)
+		{
+			::CloseHandle(file_handle_);
+			file_handle_ = nullptr;
+		}
+	}
+
+	void MappedFile::WillNeed(uint64_t offset, uint64_t length) const
+	{
+		// PrefetchVirtualMemory needs Windows 8. FILE_FLAG_SEQUENTIAL_SCAN already reads ahead.
+		DILITHIUM_UNUSED(offset);
+		DILITHIUM_UNUSED(length);
+	}
+#else
+	MappedFile::MappedFile(std::string const & file_name, AccessPattern pattern)
+	{
+		int fd = ::open(file_name.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			TERROR(("Couldn't open " + file_name).c_str());
+		}
+
+		struct stat st;
+		if (::fstat(fd, &st) != 0)
+		{
+			::close(fd);
+			TERROR(("Couldn't get the size of " + file_name).c_str());
+		}
+		size_ = static_cast<uint64_t>(st.st_size);
+
+		// Empty files can't be mapped.
+		if (size_ > 0)
+		{
+			void* p = ::mmap(nullptr, static_cast<size_t>(size_), PROT_READ, MAP_PRIVATE, fd, 0);
+			if (p == MAP_FAILED)
+			{
+				::close(fd);
+				TERROR(("Couldn't map " + file_name).c_str());
+			}
+			data_ = static_cast<uint8_t const *>(p);
+
+			switch (pattern)
+			{
+			case AccessPattern::Sequential:
+				::madvise(p, static_cast<size_t>(size_), MADV_SEQUENTIAL);
+				break;
+			case AccessPattern::Random:
+				::madvise(p, static_cast<size_t>(size_), MADV_RANDOM);
+				break;
+			default:
+				break;
+			}
+		}
+
+		// The mapping keeps the file alive.
+		::close(fd);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		this->Close();
+	}
+
+	void MappedFile::Close()
+	{
+		if (data_)
+		{
+			::munmap(const_cast<uint8_t*>(data_), static_cast<size_t>(size_));
+			data_ = nullptr;
+		}
+	}
+
+	void MappedFile::WillNeed(uint64_t offset, uint64_t length) const
+	{
+		if (!data_ || (offset >= size_))
+		{
+			return;
+		}
+
+		// madvise wants a page aligned start.
+		uint64_t const page_size = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+		uint64_t const begin = offset & ~(page_size - 1);
+		uint64_t const end = std::min(offset + length, size_);
+		::madvise(const_cast<uint8_t*>(data_) + begin, static_cast<size_t>(end - begin), MADV_WILLNEED);
+	}
+#endif
+}
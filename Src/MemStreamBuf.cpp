@@ -151,7 +151,7 @@ namespace Dilithium
 		BOOST_ASSERT(which == std::ios_base::in);
 		DILITHIUM_UNUSED(which);
 
-		if (sp < end_ - begin_)
+		if (sp <= end_ - begin_)
 		{
 			current_ = begin_ + static_cast<int>(sp);
 		}
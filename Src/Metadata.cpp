@@ -38,6 +38,9 @@
 #include <Dilithium/Metadata.hpp>
 #include "LLVMContextImpl.hpp"
 
+#include <cstring>
+#include <new>
+
 namespace
 {
 	using namespace Dilithium;
@@ -152,6 +155,24 @@ namespace Dilithium
 	{
 	}
 	
+	void* Metadata::operator new(size_t size, LLVMContext& context)
+	{
+		return context.AllocateObject(size);
+	}
+
+	void Metadata::operator delete(void* p, size_t size)
+	{
+		LLVMContext::DeallocateObject(p, size);
+	}
+
+	void Metadata::operator delete(void* p, LLVMContext& context)
+	{
+		DILITHIUM_UNUSED(context);
+
+		// The size isn't known here. Recycling the block as a smaller one is still safe.
+		LLVMContext::DeallocateObject(p, 0);
+	}
+
 	Metadata::~Metadata()
 	{
 	}
@@ -182,7 +203,7 @@ namespace Dilithium
 		auto& entry = context.Impl().metadata_as_values[md];
 		if (!entry)
 		{
-			entry = new MetadataAsValue(Type::MetadataType(context), md);
+			entry = new (context) MetadataAsValue(Type::MetadataType(context), md);
 		}
 		return entry;
 	}
@@ -404,11 +425,11 @@ namespace Dilithium
 			auto c = dyn_cast<Constant>(val);
 			if (c)
 			{
-				entry = new ConstantAsMetadata(c);
+				entry = new (context) ConstantAsMetadata(c);
 			}
 			else
 			{
-				entry = new LocalAsMetadata(val);
+				entry = new (context) LocalAsMetadata(val);
 			}
 		}
 
@@ -497,40 +518,35 @@ namespace Dilithium
 	}
 
 
-	MDString::MDString()
-		: Metadata(MDStringKind, Uniqued), string_hash_(0)
-	{
-	}
-
-	MDString::MDString(MDString&& rhs)
-		: Metadata(MDStringKind, Uniqued)
+	MDString::MDString(std::string_view str)
+		: Metadata(MDStringKind, Uniqued), length_(static_cast<uint32_t>(str.size()))
 	{
-		DILITHIUM_UNUSED(rhs);
+		std::memcpy(this + 1, str.data(), str.size());
 	}
 
 	MDString* MDString::Get(LLVMContext& context, std::string_view str)
 	{
-		auto& store = context.Impl().md_string_cache;
-		uint64_t hash_val = boost::hash_value(str);
-		auto iter = store.find(hash_val);
-		if (iter == store.end())
+		auto& impl = context.Impl();
+		auto& store = impl.md_string_cache;
+		size_t const hash_val = MDStringKeyInfo::HashValue(str);
+		auto mds = impl.prelude ? impl.prelude->md_string_cache.Find(str, hash_val) : nullptr;
+		if (!mds)
 		{
-			auto mds = std::make_unique<MDString>();
-			mds->string_ = std::string(str);
-			mds->string_hash_ = hash_val;
-
-			bool was_inserted;
-			std::tie(iter, was_inserted) = store.emplace(hash_val, std::move(mds));
-			DILITHIUM_UNUSED(was_inserted);
-			BOOST_ASSERT_MSG(was_inserted, "Expected entry to be inserted");
+			mds = store.Find(str, hash_val);
+		}
+		if (!mds)
+		{
+			void* mem = context.AllocateObject(sizeof(MDString) + str.size());
+			mds = store.Insert(::new (mem) MDString(str), hash_val);
 		}
-		return iter->second.get();
+		return mds;
 	}
 
-	std::string_view MDString::String() const
+	void MDString::Destroy(MDString* mds)
 	{
-		BOOST_ASSERT_MSG(!string_.empty(), "Expected to find string map entry");
-		return string_;
+		size_t const size = sizeof(MDString) + mds->length_;
+		mds->~MDString();
+		LLVMContext::DeallocateObject(mds, size);
 	}
 
 
@@ -945,7 +961,7 @@ namespace Dilithium
 			BOOST_ASSERT_MSG(should_create, "Expected non-uniqued nodes to always be created");
 		}
 
-		return StoreImpl(new MDTuple(context, storage, hash, mds), storage, context.Impl().MDTuples);
+		return StoreImpl(new (context) MDTuple(context, storage, hash, mds), storage, context.Impl().MDTuples);
 	}
 
 
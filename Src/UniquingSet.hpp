@@ -0,0 +1,169 @@
+/**
+ * @file UniquingSet.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of Dilithium
+ * For the latest info, see https://github.com/gongminmin/Dilithium
+ *
+ * @section LICENSE
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Minmin Gong. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _DILITHIUM_UNIQUING_SET_HPP
+#define _DILITHIUM_UNIQUING_SET_HPP
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <boost/core/noncopyable.hpp>
+
+namespace Dilithium
+{
+	// An open addressing hash set of uniqued objects, in the spirit of the DenseSets LLVM keeps its type tables in. The
+	// objects are looked up by their contents, described by KeyInfo:
+	//   KeyInfo::KeyTy, a view of the contents that is cheap to build from the arguments of a Get, e.g. from ArrayRefs
+	//   KeyInfo::HashValue(KeyTy const &)
+	//   KeyInfo::IsEqual(KeyTy const &, T const *)
+	// A lookup doesn't allocate. The hash of each entry is stored beside it, so the contents are only compared on a full
+	// hash match, and growing doesn't rehash anything. The set owns the objects, and frees them with Deleter.
+	template <typename T, typename KeyInfo, typename Deleter = std::default_delete<T>>
+	class UniquingSet : boost::noncopyable
+	{
+	public:
+		typedef typename KeyInfo::KeyTy KeyTy;
+
+	public:
+		UniquingSet()
+			: num_entries_(0)
+		{
+		}
+		~UniquingSet()
+		{
+			this->clear();
+		}
+
+		size_t size() const
+		{
+			return num_entries_;
+		}
+		bool empty() const
+		{
+			return num_entries_ == 0;
+		}
+
+		// hash has to be KeyInfo::HashValue(key).
+		T* Find(KeyTy const & key, size_t hash) const
+		{
+			if (buckets_.empty())
+			{
+				return nullptr;
+			}
+
+			size_t const mask = buckets_.size() - 1;
+			for (size_t i = hash & mask, probe = 1; ; i = (i + probe) & mask, ++ probe)
+			{
+				Bucket const & bucket = buckets_[i];
+				if (!bucket.value)
+				{
+					return nullptr;
+				}
+				if ((bucket.hash == hash) && KeyInfo::IsEqual(key, bucket.value))
+				{
+					return bucket.value;
+				}
+			}
+		}
+
+		// Takes the ownership of val, which mustn't be in the set yet. hash is the value Find was called with.
+		T* Insert(T* val, size_t hash)
+		{
+			if ((num_entries_ + 1) * 4 > buckets_.size() * 3)
+			{
+				this->Grow();
+			}
+			this->InsertNoGrow(val, hash);
+			++ num_entries_;
+			return val;
+		}
+
+		void clear()
+		{
+			for (auto& bucket : buckets_)
+			{
+				if (bucket.value)
+				{
+					Deleter()(bucket.value);
+				}
+			}
+			buckets_.clear();
+			num_entries_ = 0;
+		}
+
+	private:
+		struct Bucket
+		{
+			size_t hash;
+			T* value;
+		};
+
+		static size_t constexpr MIN_NUM_BUCKETS = 64;
+
+		void Grow()
+		{
+			std::vector<Bucket> old_buckets(buckets_.empty() ? MIN_NUM_BUCKETS : buckets_.size() * 2, Bucket{ 0, nullptr });
+			old_buckets.swap(buckets_);
+			for (auto const & bucket : old_buckets)
+			{
+				if (bucket.value)
+				{
+					this->InsertNoGrow(bucket.value, bucket.hash);
+				}
+			}
+		}
+
+		// The probe sequence steps by 1, 2, 3, ..., which visits every bucket of a power of 2 sized table.
+		void InsertNoGrow(T* val, size_t hash)
+		{
+			size_t const mask = buckets_.size() - 1;
+			size_t i = hash & mask;
+			for (size_t probe = 1; buckets_[i].value; ++ probe)
+			{
+				i = (i + probe) & mask;
+			}
+			buckets_[i].hash = hash;
+			buckets_[i].value = val;
+		}
+
+	private:
+		std::vector<Bucket> buckets_;
+		size_t num_entries_;
+	};
+}
+
+#endif		// _DILITHIUM_UNIQUING_SET_HPP
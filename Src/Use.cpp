@@ -78,13 +78,12 @@ namespace Dilithium
 
 	User* Use::GetUser() const
 	{
-		// TODO: Could be wrong, very careful of this.
-
-		// The is_ref is encoded to the last bit of this pointer
+		// The operands end either at the user itself, or, if they are hung off, at a pointer to the user with the last
+		// bit set. The first word of a user is its vtable pointer, which never has that bit set.
 		Use const * end = this->GetImpliedUser();
-		bool is_ref = (reinterpret_cast<size_t>(end) & 1) ? true : false;
-		return is_ref ? reinterpret_cast<User *>((reinterpret_cast<size_t>(end) & ~static_cast<size_t>(1)))
-			: reinterpret_cast<User *>(const_cast<Use *>(end));
+		size_t const ref = *reinterpret_cast<size_t const *>(end);
+		return (ref & 1) ? reinterpret_cast<User*>(ref & ~static_cast<size_t>(1))
+			: reinterpret_cast<User*>(const_cast<Use*>(end));
 	}
 
 	void Use::Swap(Use& rhs)
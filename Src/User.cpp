@@ -34,6 +34,10 @@
 
 #include <Dilithium/Dilithium.hpp>
 #include <Dilithium/User.hpp>
+#include <Dilithium/LLVMContext.hpp>
+
+#include <algorithm>
+#include <new>
 
 namespace Dilithium 
 {
@@ -42,19 +46,154 @@ namespace Dilithium
 	{
 		BOOST_ASSERT_MSG(num_ops < (1U << NUM_USER_OPERANDS_BITS), "Too many operands");
 		num_user_operands_ = num_ops;
-		// If we have hung off uses, then the operand list should initially be
-		// null.
-		BOOST_ASSERT_MSG(!this->OperandList(), "Error in initializing hung off uses for User");
-
-		operands_.resize(num_uses);
-		if (num_uses > 0)
+		if (num_uses == HUNG_OFF_USES)
+		{
+			// If we have hung off uses, then the operand list should initially be null.
+			has_hung_off_uses_ = true;
+			num_allocated_uses_ = 0;
+			BOOST_ASSERT_MSG(!this->OperandList(), "Error in initializing hung off uses for User");
+		}
+		else
 		{
-			Use::InitTags(operands_.data(), operands_.data() + num_uses);
+			BOOST_ASSERT_MSG(num_ops <= num_uses, "More operands than allocated");
+			num_allocated_uses_ = num_uses;
 		}
 	}
 
 	User::~User()
 	{
+		if (has_hung_off_uses_)
+		{
+			Use* ops = this->HungOffOperands();
+			if (ops)
+			{
+				ZapUses(ops, ops + num_allocated_uses_);
+				::operator delete(ops);
+			}
+		}
+		else
+		{
+			Use* ops = reinterpret_cast<Use*>(this) - num_allocated_uses_;
+			ZapUses(ops, ops + num_allocated_uses_);
+		}
+	}
+
+	void* User::operator new(size_t size, LLVMContext& context, uint32_t num_uses)
+	{
+		if (num_uses == HUNG_OFF_USES)
+		{
+			auto hung_off_operands = static_cast<Use**>(context.AllocateObject(size + sizeof(Use*)));
+			*hung_off_operands = nullptr;
+			return hung_off_operands + 1;
+		}
+
+		auto uses = static_cast<Use*>(context.AllocateObject(size + num_uses * sizeof(Use)));
+		for (uint32_t i = 0; i < num_uses; ++ i)
+		{
+			new (&uses[i]) Use;
+		}
+		Use::InitTags(uses, uses + num_uses);
+		return uses + num_uses;
+	}
+
+	void User::operator delete(void* p, size_t size)
+	{
+		if (p == nullptr)
+		{
+			return;
+		}
+
+		// Like LLVM, this reads back the layout from the destroyed user. Only its constructor writes these fields.
+		auto user = static_cast<User*>(p);
+		if (user->has_hung_off_uses_)
+		{
+			LLVMContext::DeallocateObject(static_cast<Use**>(p) - 1, size + sizeof(Use*));
+		}
+		else
+		{
+			uint32_t const num_uses = user->num_allocated_uses_;
+			LLVMContext::DeallocateObject(static_cast<Use*>(p) - num_uses, size + num_uses * sizeof(Use));
+		}
+	}
+
+	void User::operator delete(void* p, LLVMContext& context, uint32_t num_uses)
+	{
+		DILITHIUM_UNUSED(context);
+
+		// The constructor threw. The size of the object isn't known here, recycling the block as a smaller one is still
+		// safe.
+		if (num_uses == HUNG_OFF_USES)
+		{
+			LLVMContext::DeallocateObject(static_cast<Use**>(p) - 1, sizeof(Use*));
+		}
+		else
+		{
+			auto uses = static_cast<Use*>(p) - num_uses;
+			ZapUses(uses, uses + num_uses);
+			LLVMContext::DeallocateObject(uses, num_uses * sizeof(Use));
+		}
+	}
+
+	void User::AllocHungoffUses(uint32_t num_uses, bool is_phi)
+	{
+		BOOST_ASSERT_MSG(has_hung_off_uses_, "Alloc must have hung off uses");
+
+		// The operands are followed by a tagged pointer back to the user, which Use::GetUser finds.
+		size_t size = num_uses * sizeof(Use) + sizeof(size_t);
+		if (is_phi)
+		{
+			size += num_uses * sizeof(BasicBlock*);
+		}
+		auto beg = static_cast<Use*>(::operator new(size));
+		auto end = beg + num_uses;
+		for (auto iter = beg; iter != end; ++ iter)
+		{
+			new (iter) Use;
+		}
+		*reinterpret_cast<size_t*>(end) = reinterpret_cast<size_t>(this) | 1;
+
+		this->HungOffOperands() = Use::InitTags(beg, end);
+		num_allocated_uses_ = num_uses;
+	}
+
+	void User::GrowHungoffUses(uint32_t num_uses, bool is_phi)
+	{
+		BOOST_ASSERT_MSG(has_hung_off_uses_, "Realloc must have hung off uses");
+
+		uint32_t const old_num_uses = num_allocated_uses_;
+		BOOST_ASSERT_MSG(num_uses > old_num_uses, "Realloc must grow num uses");
+
+		Use* old_ops = this->OperandList();
+		this->AllocHungoffUses(num_uses, is_phi);
+		Use* new_ops = this->OperandList();
+
+		for (uint32_t i = 0; i < old_num_uses; ++ i)
+		{
+			new_ops[i] = old_ops[i];
+		}
+
+		// If this is a phi, then we need to copy the block pointers too.
+		if (is_phi)
+		{
+			auto old_bbs = reinterpret_cast<BasicBlock**>(reinterpret_cast<size_t*>(old_ops + old_num_uses) + 1);
+			auto new_bbs = reinterpret_cast<BasicBlock**>(reinterpret_cast<size_t*>(new_ops + num_uses) + 1);
+			std::copy(old_bbs, old_bbs + old_num_uses, new_bbs);
+		}
+
+		if (old_ops)
+		{
+			ZapUses(old_ops, old_ops + old_num_uses);
+			::operator delete(old_ops);
+		}
+	}
+
+	void User::ZapUses(Use* beg, Use* end)
+	{
+		while (beg != end)
+		{
+			-- end;
+			end->~Use();
+		}
 	}
 
 	Value* User::Operand(uint32_t idx) const
@@ -35,6 +35,7 @@
 #include <Dilithium/Dilithium.hpp>
 #include <Dilithium/Casting.hpp>
 #include <Dilithium/Hashing.hpp>
+#include <Dilithium/LLVMContext.hpp>
 #include <Dilithium/Metadata.hpp>
 #include <Dilithium/Operator.hpp>
 #include <Dilithium/Type.hpp>
@@ -43,7 +44,9 @@
 #include <Dilithium/ValueSymbolTable.hpp>
 
 #include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <new>
 #include <unordered_set>
 
 #include <boost/assert.hpp>
@@ -120,7 +123,7 @@ namespace
 				if (gv)
 				{
 					auto parent = gv->Parent();
-					if (gv)
+					if (parent)
 					{
 						sym_tab = parent->GetValueSymbolTable();
 					}
@@ -203,10 +206,39 @@ namespace
 
 namespace Dilithium
 {
+	ValueName::ValueName(std::string_view str, uint64_t hash)
+		: hash_(hash), length_(static_cast<uint32_t>(str.size()))
+	{
+		std::memcpy(this + 1, str.data(), str.size());
+	}
+
+	ValueName* ValueName::Create(LLVMContext& context, std::string_view str, uint64_t hash)
+	{
+		BOOST_ASSERT(hash == ValueName::HashValue(str));
+		void* mem = context.AllocateObject(sizeof(ValueName) + str.size());
+		return new (mem) ValueName(str, hash);
+	}
+
+	void ValueName::Destroy(ValueName* name)
+	{
+		if (name)
+		{
+			size_t const size = sizeof(ValueName) + name->length_;
+			name->~ValueName();
+			LLVMContext::DeallocateObject(name, size);
+		}
+	}
+
+	uint64_t ValueName::HashValue(std::string_view str)
+	{
+		return boost::hash_value(str);
+	}
+
+
 	Value::Value(Type* ty, uint32_t subclass_id)
 		: type_(ty), use_list_(nullptr), subclass_id_(static_cast<uint8_t>(subclass_id)),
 			has_value_handle_(0), subclass_optional_data_(0), subclass_data_(0),
-			num_user_operands_(0), is_used_by_md_(false), name_hash_(0)
+			num_user_operands_(0), is_used_by_md_(false), has_hung_off_uses_(false), name_(nullptr)
 	{
 		BOOST_ASSERT_MSG(ty, "Value defined with a null type: Error!");
 
@@ -222,6 +254,24 @@ namespace Dilithium
 		}
 	}
 
+	void* Value::operator new(size_t size, LLVMContext& context)
+	{
+		return context.AllocateObject(size);
+	}
+
+	void Value::operator delete(void* p, size_t size)
+	{
+		LLVMContext::DeallocateObject(p, size);
+	}
+
+	void Value::operator delete(void* p, LLVMContext& context)
+	{
+		DILITHIUM_UNUSED(context);
+
+		// The size isn't known here. Recycling the block as a smaller one is still safe.
+		LLVMContext::DeallocateObject(p, 0);
+	}
+
 	Value::~Value()
 	{
 		if (has_value_handle_)
@@ -250,13 +300,8 @@ namespace Dilithium
 
 	void Value::DestroyValueName()
 	{
-		name_.clear();
-		name_hash_ = 0;
-	}
-
-	std::string_view Value::Name() const
-	{
-		return name_;
+		ValueName::Destroy(name_);
+		name_ = nullptr;
 	}
 
 	void Value::Name(std::string_view new_name)
@@ -269,7 +314,7 @@ namespace Dilithium
 
 		BOOST_ASSERT_MSG(new_name.find_first_of('\0') == std::string_view::npos, "Null bytes are not allowed in names");
 
-		if (name_ == new_name)
+		if (this->Name() == new_name)
 		{
 			return;
 		}
@@ -284,23 +329,17 @@ namespace Dilithium
 
 		if (!sym_tab)
 		{
-			if (new_name.empty())
-			{
-				this->DestroyValueName();
-			}
-			else
+			this->DestroyValueName();
+			if (!new_name.empty())
 			{
-				this->DestroyValueName();
-
-				name_ = std::string(new_name);
-				name_hash_ = boost::hash_value(new_name);
+				name_ = ValueName::Create(this->Context(), new_name, ValueName::HashValue(new_name));
 			}
 		}
 		else
 		{
 			if (this->HasName())
 			{
-				sym_tab->RemoveValueName(name_hash_);
+				sym_tab->RemoveValueName(this);
 				this->DestroyValueName();
 
 				if (new_name.empty())
@@ -310,7 +349,6 @@ namespace Dilithium
 			}
 
 			name_ = sym_tab->CreateValueName(new_name, this);
-			name_hash_ = boost::hash_value(std::string_view(name_));
 		}
 	}
 
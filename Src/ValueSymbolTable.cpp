@@ -33,94 +33,182 @@
  */
 
 #include <Dilithium/Dilithium.hpp>
-#include <Dilithium/Hashing.hpp>
 #include <Dilithium/Type.hpp>
 #include <Dilithium/SmallString.hpp>
 #include <Dilithium/ValueSymbolTable.hpp>
 
 #include <iostream>
+#include <iterator>
 
 namespace Dilithium
 {
 	ValueSymbolTable::~ValueSymbolTable()
 	{
 #ifdef DILITHIUM_DEBUG
-		for (auto iter = vmap_.begin(), end = vmap_.end(); iter != end; ++ iter)
+		for (auto val : *this)
 		{
 			std::clog << "Value still in symbol table! Type = '"
-				<< *iter->second->GetType() << "' Name = '"
-				<< iter->second->Name() << "'" << std::endl;
+				<< *val->GetType() << "' Name = '"
+				<< val->Name() << "'" << std::endl;
 		}
-		BOOST_ASSERT_MSG(vmap_.empty(), "Values remain in symbol table!");
+		BOOST_ASSERT_MSG(this->empty(), "Values remain in symbol table!");
 #endif
 	}
 
+	Value* ValueSymbolTable::Lookup(std::string_view name) const
+	{
+		size_t const index = this->FindBucket(name, ValueName::HashValue(name));
+		return (index == NOT_FOUND) ? nullptr : buckets_[index].val;
+	}
+
 	void ValueSymbolTable::ReinsertValue(Value* val)
 	{
 		BOOST_ASSERT_MSG(val->HasName(), "Can't insert nameless Value into symbol table");
 
-		auto iter = vmap_.find(val->NameHash());
-		if (iter == vmap_.end())
+		std::string_view const name = val->Name();
+		if (this->FindBucket(name, val->NameHash()) == NOT_FOUND)
 		{
-			vmap_.emplace(val->NameHash(), val);
+			this->InsertBucket(val, val->NameHash());
 		}
 		else
 		{
-			SmallString<256> unique_name(val->Name().begin(), val->Name().end());
+			SmallString<256> unique_name(name);
+			uint64_t const hash_val = this->MakeUniqueName(unique_name, true);
 
-			size_t base_size = unique_name.size();
-			for (;;)
-			{
-				unique_name.resize(base_size);
-				++ last_unique_;
-				unique_name.append('.' + std::to_string(last_unique_));
+			ValueName* new_name = ValueName::Create(val->Context(), unique_name.str(), hash_val);
+			val->DestroyValueName();
+			val->name_ = new_name;
+			this->InsertBucket(val, hash_val);
+		}
+	}
 
-				uint64_t hash_val = boost::hash_value(unique_name.str());
+	void ValueSymbolTable::RemoveValueName(Value* val)
+	{
+		BOOST_ASSERT(!buckets_.empty());
 
-				iter = vmap_.find(hash_val);
-				if (iter == vmap_.end())
-				{
-					vmap_.emplace(hash_val, val);
-					val->Name(unique_name);
-					return;
-				}
+		size_t const mask = buckets_.size() - 1;
+		size_t i = val->NameHash() & mask;
+		while (buckets_[i].val != val)
+		{
+			BOOST_ASSERT_MSG(buckets_[i].val, "Value isn't in the symbol table!");
+			i = (i + 1) & mask;
+		}
+
+		// Shift the entries after it back, so no probe sequence gets broken by the hole.
+		for (size_t j = (i + 1) & mask; buckets_[j].val; j = (j + 1) & mask)
+		{
+			size_t const home = buckets_[j].hash & mask;
+			bool const reachable = (i <= j) ? ((i < home) && (home <= j)) : ((i < home) || (home <= j));
+			if (!reachable)
+			{
+				buckets_[i] = buckets_[j];
+				i = j;
 			}
 		}
+		buckets_[i].hash = 0;
+		buckets_[i].val = nullptr;
+		-- num_entries_;
 	}
 
-	void ValueSymbolTable::RemoveValueName(uint64_t name_hash)
+	ValueName* ValueSymbolTable::CreateValueName(std::string_view name, Value* val)
 	{
-		BOOST_ASSERT(vmap_.find(name_hash) != vmap_.end());
-		vmap_.erase(name_hash);
+		uint64_t hash_val = ValueName::HashValue(name);
+		if (this->FindBucket(name, hash_val) == NOT_FOUND)
+		{
+			this->InsertBucket(val, hash_val);
+			return ValueName::Create(val->Context(), name, hash_val);
+		}
+		else
+		{
+			SmallString<256> unique_name(name);
+			hash_val = this->MakeUniqueName(unique_name, false);
+			this->InsertBucket(val, hash_val);
+			return ValueName::Create(val->Context(), unique_name.str(), hash_val);
+		}
 	}
 
-	std::string ValueSymbolTable::CreateValueName(std::string_view name, Value* val)
+	uint64_t ValueSymbolTable::MakeUniqueName(SmallString<256>& name, bool with_dot)
 	{
-		uint64_t hash_val = boost::hash_value(name);
+		size_t const base_size = name.size();
+		for (;;)
+		{
+			name.resize(base_size);
+			if (with_dot)
+			{
+				name.push_back('.');
+			}
+
+			++ last_unique_;
+			char digits[10];
+			char* first = std::end(digits);
+			uint32_t n = last_unique_;
+			do
+			{
+				*-- first = static_cast<char>('0' + n % 10);
+				n /= 10;
+			} while (n != 0);
+			name.append(first, std::end(digits));
+
+			uint64_t const hash_val = ValueName::HashValue(name.str());
+			if (this->FindBucket(name.str(), hash_val) == NOT_FOUND)
+			{
+				return hash_val;
+			}
+		}
+	}
 
-		auto iter = vmap_.find(hash_val);
-		if (iter == vmap_.end())
+	size_t ValueSymbolTable::FindBucket(std::string_view name, uint64_t hash) const
+	{
+		if (buckets_.empty())
 		{
-			vmap_.emplace(hash_val, val);
-			return std::string(name);
+			return NOT_FOUND;
 		}
-		else
+
+		size_t const mask = buckets_.size() - 1;
+		for (size_t i = hash & mask; buckets_[i].val; i = (i + 1) & mask)
 		{
-			SmallString<256> unique_name(name.begin(), name.end());
-			for (;;)
+			if ((buckets_[i].hash == hash) && (buckets_[i].val->Name() == name))
 			{
-				unique_name.resize(name.size());
-				++ last_unique_;
-				unique_name.append(std::to_string(last_unique_));
+				return i;
+			}
+		}
+		return NOT_FOUND;
+	}
 
-				hash_val = boost::hash_value(unique_name.str());
+	void ValueSymbolTable::InsertBucket(Value* val, uint64_t hash)
+	{
+		if ((num_entries_ + 1) * 4 > buckets_.size() * 3)
+		{
+			this->Grow();
+		}
 
-				iter = vmap_.find(hash_val);
-				if (iter == vmap_.end())
+		size_t const mask = buckets_.size() - 1;
+		size_t i = hash & mask;
+		while (buckets_[i].val)
+		{
+			i = (i + 1) & mask;
+		}
+		buckets_[i].hash = hash;
+		buckets_[i].val = val;
+		++ num_entries_;
+	}
+
+	void ValueSymbolTable::Grow()
+	{
+		std::vector<Bucket> old_buckets(buckets_.empty() ? 16 : buckets_.size() * 2, Bucket{ 0, nullptr });
+		old_buckets.swap(buckets_);
+
+		size_t const mask = buckets_.size() - 1;
+		for (auto const & bucket : old_buckets)
+		{
+			if (bucket.val)
+			{
+				size_t i = bucket.hash & mask;
+				while (buckets_[i].val)
 				{
-					vmap_.emplace(hash_val, val);
-					return std::string(unique_name.str());
+					i = (i + 1) & mask;
 				}
+				buckets_[i] = bucket;
 			}
 		}
 	}
@@ -0,0 +1,818 @@
+/**
+ * @file DilithiumBench.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of Dilithium
+ * For the latest info, see https://github.com/gongminmin/Dilithium
+ *
+ * @section LICENSE
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Minmin Gong. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <vector>
+#include <string>
+#include <iomanip>
+
+#include <Dilithium/Dilithium.hpp>
+#include <Dilithium/BitcodeBlockIndex.hpp>
+#include <Dilithium/BitstreamReader.hpp>
+#include <Dilithium/Constants.hpp>
+#include <Dilithium/DerivedType.hpp>
+#include <Dilithium/LLVMContext.hpp>
+#include <Dilithium/MappedFile.hpp>
+#include <Dilithium/MemStreamBuf.hpp>
+#include <Dilithium/dxc/HLSL/DxilContainer.hpp>
+#include <Dilithium/dxc/HLSL/DxilMdHelper.hpp>
+#include <Dilithium/dxc/HLSL/DxilModule.hpp>
+
+using namespace Dilithium;
+
+namespace
+{
+	std::atomic<uint64_t> num_allocations(0);
+	std::atomic<uint64_t> num_allocated_bytes(0);
+
+	void* CountedAlloc(std::size_t size)
+	{
+		num_allocations.fetch_add(1, std::memory_order_relaxed);
+		num_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+		return std::malloc(size ? size : 1);
+	}
+}
+
+// Every heap allocation of the process goes through here, so the module benchmarks can count them.
+void* operator new(std::size_t size)
+{
+	void* p = CountedAlloc(size);
+	if (!p)
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+void* operator new(std::size_t size, std::nothrow_t const &) noexcept
+{
+	return CountedAlloc(size);
+}
+void* operator new[](std::size_t size, std::nothrow_t const &) noexcept
+{
+	return CountedAlloc(size);
+}
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+void operator delete[](void* p) noexcept
+{
+	std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+void operator delete[](void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+namespace
+{
+	struct Shader
+	{
+		std::string name;
+		std::shared_ptr<MappedFile> file;
+		uint8_t const * bitcode;
+		uint32_t bitcode_length;
+	};
+
+	// How WalkBlock treats each record, besides decoding it once.
+	enum class Redecode
+	{
+		None,
+		Abbreviated,		// Decode abbreviated records a second time.
+		Unabbreviated,		// Decode unabbreviated records a second time.
+		SeekOnly			// Seek after every record, as the two above do, but don't decode again.
+	};
+
+	struct WalkStats
+	{
+		uint64_t num_records = 0;
+		uint64_t num_abbreviated_records = 0;
+		uint64_t checksum = 0;
+	};
+
+	void WalkBlock(BitStreamCursor& cursor, WalkStats& stats, Redecode redecode)
+	{
+		boost::container::small_vector<uint64_t, 64> record;
+		for (;;)
+		{
+			BitStreamEntry entry = cursor.Advance();
+			switch (entry.kind)
+			{
+			case BitStreamEntry::Error:
+				TERROR("Malformed block");
+				break;
+
+			case BitStreamEntry::EndBlock:
+				return;
+
+			case BitStreamEntry::SubBlock:
+				if (entry.id == BitCode::StandardBlockId::BlockInfoBlockId)
+				{
+					if (cursor.ReadBlockInfoBlock())
+					{
+						TERROR("Malformed block");
+					}
+				}
+				else
+				{
+					if (cursor.EnterSubBlock(entry.id))
+					{
+						TERROR("Invalid record");
+					}
+					WalkBlock(cursor, stats, redecode);
+				}
+				break;
+
+			case BitStreamEntry::Record:
+				{
+					// ReadRecord picks up right after the abbreviation ID Advance has read.
+					uint64_t const record_bit_no = cursor.CurrBitNo();
+
+					bool const abbreviated = entry.id != BitCode::FixedAbbrevId::UnabbrevRecord;
+					record.clear();
+					stats.checksum += cursor.ReadRecord(entry.id, record);
+					for (auto v : record)
+					{
+						stats.checksum = stats.checksum * 31 + v;
+					}
+					++ stats.num_records;
+					if (abbreviated)
+					{
+						++ stats.num_abbreviated_records;
+					}
+
+					if ((redecode == Redecode::SeekOnly)
+						|| ((redecode == Redecode::Abbreviated) && abbreviated)
+						|| ((redecode == Redecode::Unabbreviated) && !abbreviated))
+					{
+						uint64_t const end_bit_no = cursor.CurrBitNo();
+						if (redecode == Redecode::SeekOnly)
+						{
+							cursor.JumpToBit(end_bit_no);
+						}
+						else
+						{
+							cursor.JumpToBit(record_bit_no);
+							record.clear();
+							stats.checksum += cursor.ReadRecord(entry.id, record);
+							BOOST_ASSERT(cursor.CurrBitNo() == end_bit_no);
+						}
+					}
+				}
+				break;
+			}
+		}
+	}
+
+	// Decodes every record of every block in the stream, without building any IR.
+	WalkStats WalkBitStream(BitStreamReader& reader, Redecode redecode = Redecode::None)
+	{
+		BitStreamCursor cursor(reader);
+		if ((cursor.Read(8) != 'B')
+			|| (cursor.Read(8) != 'C')
+			|| (cursor.Read(8) != 0xC0)
+			|| (cursor.Read(8) != 0xDE))
+		{
+			TERROR("Invalid bitcode signature");
+		}
+
+		WalkStats stats;
+		while (!cursor.AtEndOfStream())
+		{
+			BitStreamEntry entry = cursor.Advance(BitStreamCursor::AF_DontAutoprocessAbbrevs);
+			if (entry.kind != BitStreamEntry::SubBlock)
+			{
+				TERROR("Malformed block");
+			}
+			if (cursor.EnterSubBlock(entry.id))
+			{
+				TERROR("Invalid record");
+			}
+			WalkBlock(cursor, stats, redecode);
+		}
+		return stats;
+	}
+
+	// Packs values into a bitstream the way the bitcode writer does.
+	class BitWriter
+	{
+	public:
+		void Emit(uint64_t val, uint32_t num_bits)
+		{
+			BOOST_ASSERT((num_bits <= 32) && (val >> num_bits) == 0);
+
+			curr_ |= val << num_bits_;
+			num_bits_ += num_bits;
+			while (num_bits_ >= 8)
+			{
+				bytes_.push_back(static_cast<uint8_t>(curr_));
+				curr_ >>= 8;
+				num_bits_ -= 8;
+			}
+		}
+
+		void EmitVBR64(uint64_t val, uint32_t num_bits)
+		{
+			uint64_t const threshold = 1ULL << (num_bits - 1);
+			while (val >= threshold)
+			{
+				this->Emit((val & (threshold - 1)) | threshold, num_bits);
+				val >>= num_bits - 1;
+			}
+			this->Emit(val, num_bits);
+		}
+
+		std::vector<uint8_t> Finish()
+		{
+			if (num_bits_ > 0)
+			{
+				bytes_.push_back(static_cast<uint8_t>(curr_));
+			}
+			while (bytes_.size() & 3)
+			{
+				bytes_.push_back(0);
+			}
+			curr_ = 0;
+			num_bits_ = 0;
+			return std::move(bytes_);
+		}
+
+	private:
+		std::vector<uint8_t> bytes_;
+		uint64_t curr_ = 0;
+		uint32_t num_bits_ = 0;
+	};
+
+	bool LoadShader(std::string const & file_name, Shader& shader)
+	{
+		try
+		{
+			DxilContainerFileView const file(file_name);
+			shader.name = file_name;
+			shader.file = file.File();
+
+			auto const & container = file.ContainerView();
+			if (container.Valid())
+			{
+				// The release program, even if the container has a debug one too.
+				auto const program = container.PartData(DFCC_DXIL);
+				auto program_header = reinterpret_cast<DxilProgramHeader const *>(program.data());
+				if (program.empty() || !IsValidDxilProgramHeader(program_header, static_cast<uint32_t>(program.size())))
+				{
+					return false;
+				}
+				GetDxilProgramBitcode(program_header, &shader.bitcode, &shader.bitcode_length);
+			}
+			else if (IsDxilContainerLike(file.Data(), file.Size()))
+			{
+				return false;
+			}
+			else if (file.Program())
+			{
+				GetDxilProgramBitcode(file.Program(), &shader.bitcode, &shader.bitcode_length);
+			}
+			else
+			{
+				shader.bitcode = file.Data();
+				shader.bitcode_length = file.Size();
+			}
+			return shader.bitcode_length != 0;
+		}
+		catch (std::exception&)
+		{
+			return false;
+		}
+	}
+
+	template <typename Func>
+	double TimeIt(uint32_t iterations, Func func)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < iterations; ++ i)
+		{
+			func();
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<double, std::nano>(end - start).count();
+	}
+
+	void PrintResult(char const * name, double ns, uint64_t num_items, uint64_t num_bytes, char const * unit = "record")
+	{
+		std::cout << "  " << std::left << std::setw(24) << name << std::right
+			<< std::fixed << std::setprecision(2)
+			<< std::setw(10) << ns / num_items << " ns/" << unit
+			<< std::setw(10) << num_bytes / ns * 1e3 << " MB/s" << std::endl;
+	}
+
+	void BenchBitStreamCursor(std::vector<Shader> const & shaders, uint32_t iterations)
+	{
+		std::cout << "BitStreamCursor (" << iterations << " iterations)" << std::endl;
+
+		uint64_t num_bytes = 0;
+		uint64_t num_records = 0;
+		double memory_ns = 0;
+		double stream_ns = 0;
+		for (auto const & shader : shaders)
+		{
+			uint8_t const * beg = shader.bitcode;
+			uint8_t const * end = beg + shader.bitcode_length;
+
+			BitStreamReader memory_reader(beg, end);
+			BitStreamReader stream_reader(std::make_unique<MemStreamBuf>(beg, end), shader.bitcode_length);
+
+			WalkStats memory_stats = WalkBitStream(memory_reader);
+			WalkStats stream_stats = WalkBitStream(stream_reader);
+			if ((memory_stats.num_records != stream_stats.num_records) || (memory_stats.checksum != stream_stats.checksum))
+			{
+				TERROR(("Cursor mismatch in " + shader.name).c_str());
+			}
+
+			memory_ns += TimeIt(iterations, [&memory_reader] { WalkBitStream(memory_reader); });
+			stream_ns += TimeIt(iterations, [&stream_reader] { WalkBitStream(stream_reader); });
+
+			num_bytes += static_cast<uint64_t>(shader.bitcode_length) * iterations;
+			num_records += memory_stats.num_records * iterations;
+		}
+
+		PrintResult("Memory", memory_ns, num_records, num_bytes);
+		PrintResult("Stream", stream_ns, num_records, num_bytes);
+		std::cout << std::endl;
+	}
+
+	// Read and ReadVBR64 on their own, over synthetic streams shaped like typical operands: mostly small values.
+	void BenchReads(uint32_t iterations)
+	{
+		uint32_t constexpr NUM_VALUES = 64 * 1024;
+		uint32_t constexpr FIXED_WIDTH = 13;
+		uint32_t constexpr VBR_WIDTH = 6;
+
+		std::mt19937_64 rng(0x1234);
+		std::vector<uint64_t> values(NUM_VALUES);
+		for (auto& v : values)
+		{
+			uint64_t const r = rng();
+			switch (r % 20)
+			{
+			case 0:
+				v = (r >> 8) & 0xFFFFFFFF;
+				break;
+			case 1:
+			case 2:
+			case 3:
+			case 4:
+			case 5:
+				v = (r >> 8) & 0xFFF;
+				break;
+			default:
+				v = (r >> 8) & 0x1F;
+				break;
+			}
+		}
+
+		BitWriter fixed_writer;
+		BitWriter vbr_writer;
+		uint64_t fixed_sum = 0;
+		uint64_t vbr_sum = 0;
+		for (auto v : values)
+		{
+			fixed_writer.Emit(v & ((1U << FIXED_WIDTH) - 1), FIXED_WIDTH);
+			fixed_sum += v & ((1U << FIXED_WIDTH) - 1);
+			vbr_writer.EmitVBR64(v, VBR_WIDTH);
+			vbr_sum += v;
+		}
+		auto const fixed_bits = fixed_writer.Finish();
+		auto const vbr_bits = vbr_writer.Finish();
+
+		BitStreamReader fixed_reader(fixed_bits.data(), fixed_bits.data() + fixed_bits.size());
+		BitStreamReader vbr_reader(vbr_bits.data(), vbr_bits.data() + vbr_bits.size());
+
+		uint64_t sum = 0;
+		double const fixed_ns = TimeIt(iterations, [&fixed_reader, &sum]
+			{
+				BitStreamCursor cursor(fixed_reader);
+				for (uint32_t i = 0; i < NUM_VALUES; ++ i)
+				{
+					sum += cursor.Read(FIXED_WIDTH);
+				}
+			});
+		if (sum != fixed_sum * iterations)
+		{
+			TERROR("Read mismatch");
+		}
+
+		sum = 0;
+		double const vbr_ns = TimeIt(iterations, [&vbr_reader, &sum]
+			{
+				BitStreamCursor cursor(vbr_reader);
+				for (uint32_t i = 0; i < NUM_VALUES; ++ i)
+				{
+					sum += cursor.ReadVBR64(VBR_WIDTH);
+				}
+			});
+		if (sum != vbr_sum * iterations)
+		{
+			TERROR("ReadVBR64 mismatch");
+		}
+
+		std::cout << "BitStreamCursor reads (" << iterations << " iterations of " << NUM_VALUES << " values)" << std::endl;
+		uint64_t const num_values = static_cast<uint64_t>(NUM_VALUES) * iterations;
+		PrintResult("Read(13)", fixed_ns, num_values, fixed_bits.size() * iterations, "value");
+		PrintResult("ReadVBR64(6)", vbr_ns, num_values, vbr_bits.size() * iterations, "value");
+		std::cout << std::endl;
+	}
+
+	// ConstantInt::Get on the values a constants block is mostly made of, small immediates. The same values go through
+	// the tables of i32 and through int_constants as i33, a width without a table. The context is made outside the
+	// timing, and only the first iteration creates the constants, so this is the cost of a lookup.
+	void BenchConstantInts(uint32_t iterations)
+	{
+		uint32_t constexpr NUM_VALUES = 4 * 1024;
+		uint32_t constexpr NUM_DISTINCT = 256;
+
+		std::mt19937_64 rng(0x5678);
+		std::vector<uint64_t> values(NUM_VALUES);
+		for (auto& v : values)
+		{
+			v = rng() % NUM_DISTINCT;
+		}
+
+		LLVMContext context;
+		auto get_all = [&values](IntegerType* ty)
+		{
+			uintptr_t checksum = 0;
+			for (auto v : values)
+			{
+				checksum += reinterpret_cast<uintptr_t>(ConstantInt::Get(ty, v));
+			}
+			return checksum;
+		};
+
+		uintptr_t checksum = 0;
+		IntegerType* const table_ty = Type::Int32Type(context);
+		double const table_ns = TimeIt(iterations, [&get_all, table_ty, &checksum]
+			{
+				checksum += get_all(table_ty);
+			});
+		IntegerType* const map_ty = IntegerType::Get(context, 33);
+		double const map_ns = TimeIt(iterations, [&get_all, map_ty, &checksum]
+			{
+				checksum += get_all(map_ty);
+			});
+		if (checksum == 0)
+		{
+			TERROR("ConstantInt::Get returned nothing");
+		}
+
+		std::cout << "ConstantInt::Get (" << iterations << " iterations of " << NUM_VALUES << " values)" << std::endl;
+		uint64_t const num_values = static_cast<uint64_t>(NUM_VALUES) * iterations;
+		PrintResult("Small int table", table_ns, num_values, num_values * sizeof(uint64_t), "constant");
+		PrintResult("int_constants", map_ns, num_values, num_values * sizeof(uint64_t), "constant");
+		std::cout << std::endl;
+	}
+
+	// A record can't be decoded in isolation, so the cost of each kind is what a walk that decodes it twice takes over
+	// a walk that only seeks as often.
+	void BenchReadRecord(std::vector<Shader> const & shaders, uint32_t iterations)
+	{
+		std::cout << "BitStreamCursor::ReadRecord (" << iterations << " iterations)" << std::endl;
+
+		uint64_t num_abbreviated = 0;
+		uint64_t num_unabbreviated = 0;
+		double base_ns = 0;
+		double seek_ns = 0;
+		double abbreviated_ns = 0;
+		double unabbreviated_ns = 0;
+		for (auto const & shader : shaders)
+		{
+			BitStreamReader reader(shader.bitcode, shader.bitcode + shader.bitcode_length);
+			WalkStats stats = WalkBitStream(reader);
+
+			base_ns += TimeIt(iterations, [&reader] { WalkBitStream(reader); });
+			seek_ns += TimeIt(iterations, [&reader] { WalkBitStream(reader, Redecode::SeekOnly); });
+			abbreviated_ns += TimeIt(iterations, [&reader] { WalkBitStream(reader, Redecode::Abbreviated); });
+			unabbreviated_ns += TimeIt(iterations, [&reader] { WalkBitStream(reader, Redecode::Unabbreviated); });
+
+			num_abbreviated += stats.num_abbreviated_records * iterations;
+			num_unabbreviated += (stats.num_records - stats.num_abbreviated_records) * iterations;
+		}
+
+		// Both redecoding walks seek after every record of one kind, the seeking walk after every record.
+		double const seek_ns_per_record = (seek_ns - base_ns) / (num_abbreviated + num_unabbreviated);
+		auto print = [base_ns, seek_ns_per_record](char const * name, double ns, uint64_t num_records)
+		{
+			std::cout << "  " << std::left << std::setw(24) << name << std::right;
+			if (num_records == 0)
+			{
+				std::cout << "       n/a" << std::endl;
+				return;
+			}
+			std::cout << std::fixed << std::setprecision(2)
+				<< std::setw(10) << (ns - base_ns) / num_records - seek_ns_per_record << " ns/record"
+				<< std::setw(12) << num_records << " records" << std::endl;
+		};
+		print("Abbreviated", abbreviated_ns, num_abbreviated);
+		print("Unabbreviated", unabbreviated_ns, num_unabbreviated);
+		std::cout << std::endl;
+	}
+
+	// Building the index of each shader, and checking that it comes back the same from Serialize and Deserialize, and
+	// that it doesn't match the same bitcode with a word changed.
+	void BenchBlockIndex(std::vector<Shader> const & shaders, uint32_t iterations)
+	{
+		std::cout << "BitcodeBlockIndex (" << iterations << " iterations)" << std::endl;
+
+		uint64_t num_bytes = 0;
+		uint64_t num_blocks = 0;
+		double build_ns = 0;
+		double round_trip_ns = 0;
+		for (auto const & shader : shaders)
+		{
+			BitcodeBlockIndex const index(shader.bitcode, shader.bitcode_length, true);
+			std::vector<uint8_t> const serialized = index.Serialize();
+			BitcodeBlockIndex const deserialized = BitcodeBlockIndex::Deserialize(serialized.data(), serialized.size());
+
+			bool same = (deserialized.BitcodeLength() == index.BitcodeLength())
+				&& (deserialized.BitcodeHash() == index.BitcodeHash()) && (deserialized.NumBlocks() == index.NumBlocks())
+				&& deserialized.Matches(shader.bitcode, shader.bitcode_length);
+			for (uint32_t i = 0; same && (i < index.NumBlocks()); ++ i)
+			{
+				auto const & lhs = index.GetBlock(i);
+				auto const & rhs = deserialized.GetBlock(i);
+				same = (lhs.block_id == rhs.block_id) && (lhs.parent == rhs.parent) && (lhs.bit_offset == rhs.bit_offset)
+					&& (lhs.num_bits == rhs.num_bits);
+			}
+			if (!same)
+			{
+				TERROR("Block index doesn't survive a round trip");
+			}
+
+			std::vector<uint8_t> changed(shader.bitcode, shader.bitcode + shader.bitcode_length);
+			changed.back() ^= 0xFF;
+			if (deserialized.Matches(changed.data(), static_cast<uint32_t>(changed.size())))
+			{
+				TERROR("Block index matches different bitcode");
+			}
+
+			build_ns += TimeIt(iterations, [&shader]
+				{
+					BitcodeBlockIndex(shader.bitcode, shader.bitcode_length, true);
+				});
+			round_trip_ns += TimeIt(iterations, [&index]
+				{
+					auto const data = index.Serialize();
+					BitcodeBlockIndex::Deserialize(data.data(), data.size());
+				});
+			num_bytes += static_cast<uint64_t>(shader.bitcode_length) * iterations;
+			num_blocks += static_cast<uint64_t>(index.NumBlocks()) * iterations;
+		}
+
+		PrintResult("Build", build_ns, num_blocks, num_bytes, "block");
+		PrintResult("Serialize/Deserialize", round_trip_ns, num_blocks, num_bytes, "block");
+		std::cout << std::endl;
+	}
+
+	struct ModuleResult
+	{
+		double ns = 0;
+		uint64_t num_records = 0;
+		uint64_t num_bytes = 0;
+		uint64_t num_modules = 0;
+		uint64_t num_allocations = 0;
+		uint64_t num_allocated_bytes = 0;
+	};
+
+	// Times func on one shader, and counts the heap allocations of its first run. Returns false if the shader isn't
+	// supported.
+	template <typename Func>
+	bool TimeModule(Shader const & shader, uint32_t iterations, Func func, ModuleResult& result)
+	{
+		try
+		{
+			uint64_t const allocations = num_allocations.load();
+			uint64_t const allocated_bytes = num_allocated_bytes.load();
+			func();
+			result.num_allocations += num_allocations.load() - allocations;
+			result.num_allocated_bytes += num_allocated_bytes.load() - allocated_bytes;
+		}
+		catch (std::exception& ex)
+		{
+			std::cout << "  " << shader.name << " skipped: " << ex.what() << std::endl;
+			return false;
+		}
+
+		BitStreamReader reader(shader.bitcode, shader.bitcode + shader.bitcode_length);
+		result.ns += TimeIt(iterations, func);
+		result.num_records += WalkBitStream(reader).num_records * iterations;
+		result.num_bytes += static_cast<uint64_t>(shader.bitcode_length) * iterations;
+		result.num_modules += 1;
+		return true;
+	}
+
+	void PrintModuleResult(char const * name, ModuleResult const & result, uint32_t iterations)
+	{
+		if (result.num_modules == 0)
+		{
+			std::cout << "  " << std::left << std::setw(24) << name << std::right << "       n/a" << std::endl;
+			return;
+		}
+
+		PrintResult(name, result.ns, result.num_records, result.num_bytes);
+		std::cout << "  " << std::left << std::setw(24) << "" << std::right
+			<< std::fixed << std::setprecision(2)
+			<< std::setw(10) << result.ns / (static_cast<double>(result.num_modules) * iterations) / 1000 << " us/module"
+			<< std::setw(10) << static_cast<double>(result.num_allocations) / result.num_modules << " allocs/module"
+			<< std::setw(10) << static_cast<double>(result.num_allocated_bytes) / result.num_modules / 1024 << " KB/module"
+			<< std::endl;
+	}
+
+	void BenchModules(std::vector<Shader> const & shaders, uint32_t iterations)
+	{
+		std::cout << "Modules (" << iterations << " iterations)" << std::endl;
+
+		auto const & prelude = DxilMDHelper::ContextPrelude();
+
+		ModuleResult load_result;
+		ModuleResult without_bodies_result;
+		ModuleResult prelude_result;
+		ModuleResult block_index_result;
+		ModuleResult metadata_result;
+		ModuleResult all_sections_result;
+		for (auto const & shader : shaders)
+		{
+			TimeModule(shader, iterations,
+				[&shader]
+				{
+					LoadLLVMModule(BitcodeSource(shader.bitcode, shader.bitcode_length), "",
+						LoadOptions{ BitcodeLoadMode::WithoutBodies });
+				},
+				without_bodies_result);
+			TimeModule(shader, iterations,
+				[&shader, &prelude]
+				{
+					LoadLLVMModule(BitcodeSource(shader.bitcode, shader.bitcode_length), "",
+						LoadOptions{ BitcodeLoadMode::WithoutBodies, nullptr, prelude });
+				},
+				prelude_result);
+
+			if (!TimeModule(shader, iterations,
+				[&shader] { LoadLLVMModule(BitcodeSource(shader.bitcode, shader.bitcode_length), ""); },
+				load_result))
+			{
+				continue;
+			}
+			BitcodeBlockIndex const index(shader.bitcode, shader.bitcode_length);
+			TimeModule(shader, iterations,
+				[&shader, &index]
+				{
+					LoadLLVMModule(BitcodeSource(shader.bitcode, shader.bitcode_length), "",
+						LoadOptions{ BitcodeLoadMode::Full, &index });
+				},
+				block_index_result);
+
+			auto module = LoadLLVMModule(BitcodeSource(shader.bitcode, shader.bitcode_length), "");
+			if (!module->GetNamedMetadata("dx.version"))
+			{
+				continue;
+			}
+			TimeModule(shader, iterations, [&module]
+				{
+					DxilModule dxil_module(module.get());
+					dxil_module.LoadDxilMetadata();
+				},
+				metadata_result);
+			// LoadDxilMetadata leaves the other sections until they are asked for. This is the cost of all of them.
+			TimeModule(shader, iterations, [&module]
+				{
+					DxilModule dxil_module(module.get());
+					dxil_module.LoadDxilMetadata();
+					dxil_module.LoadSections(DxilModule::MS_All);
+				},
+				all_sections_result);
+		}
+
+		PrintModuleResult("LoadLLVMModule", load_result, iterations);
+		PrintModuleResult("Without bodies", without_bodies_result, iterations);
+		PrintModuleResult("With DXIL prelude", prelude_result, iterations);
+		PrintModuleResult("With block index", block_index_result, iterations);
+		PrintModuleResult("LoadDxilMetadata", metadata_result, iterations);
+		PrintModuleResult("All metadata sections", all_sections_result, iterations);
+		std::cout << std::endl;
+	}
+}
+
+void Usage()
+{
+	std::cerr << "Dilithium bitstream and bitcode reader benchmarks." << std::endl;
+	std::cerr << "This program is free software, released under a MIT license" << std::endl;
+	std::cerr << std::endl;
+	std::cerr << "Usage: DilithiumBench [-n ITERATIONS] [-m] INPUT..." << std::endl;
+	std::cerr << std::endl;
+	std::cerr << "-m runs LoadLLVMModule and LoadDxilMetadata in release builds too. In these builds, inputs that use" << std::endl;
+	std::cerr << "   something the reader doesn't implement yet are undefined behavior instead of being skipped." << std::endl;
+	std::cerr << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t iterations = 1000;
+	bool bench_modules = DILITHIUM_UNREACHABLE_THROWS;
+	std::vector<Shader> shaders;
+	for (int i = 1; i < argc; ++ i)
+	{
+		std::string arg = argv[i];
+		if ((arg == "-n") && (i + 1 < argc))
+		{
+			++ i;
+			iterations = std::stoul(argv[i]);
+			continue;
+		}
+		if (arg == "-m")
+		{
+			bench_modules = true;
+			continue;
+		}
+
+		shaders.emplace_back();
+		if (!LoadShader(arg, shaders.back()))
+		{
+			std::cerr << "Couldn't load " << arg << std::endl;
+			shaders.pop_back();
+		}
+	}
+
+	if (shaders.empty())
+	{
+		Usage();
+		return 1;
+	}
+
+	try
+	{
+		BenchBitStreamCursor(shaders, iterations);
+		BenchReads(iterations);
+		BenchReadRecord(shaders, iterations);
+		BenchBlockIndex(shaders, iterations);
+		BenchConstantInts(iterations);
+		if (bench_modules)
+		{
+			BenchModules(shaders, iterations);
+		}
+		else
+		{
+			std::cout << "Modules skipped, pass -m to run them." << std::endl;
+		}
+	}
+	catch (std::exception& ex)
+	{
+		std::cerr << ex.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
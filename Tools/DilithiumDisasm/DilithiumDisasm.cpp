@@ -32,7 +32,9 @@
  * THE SOFTWARE.
  */
 
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -40,21 +42,26 @@
 #include <string>
 #include <algorithm>
 #include <iomanip>
+#include <iterator>
+#include <map>
+#include <memory>
+
+#ifdef _WIN32
+#include <cstdio>
+#include <fcntl.h>
+#include <io.h>
+#endif
 
 #include <Dilithium/Dilithium.hpp>
+#include <Dilithium/MappedFile.hpp>
 #include <Dilithium/dxc/HLSL/DxilContainer.hpp>
+#include <Dilithium/dxc/HLSL/DxilContainerReflection.hpp>
 #include <Dilithium/dxc/HLSL/DxilPipelineStateValidation.hpp>
 
 using namespace Dilithium;
 
 namespace
 {
-	template <typename T>
-	T const * ByteOffset(void const * p, uint32_t byte_offset)
-	{
-		return reinterpret_cast<T const *>(static_cast<uint8_t const *>(p) + byte_offset);
-	}
-
 	void PrintFeatureInfo(DxilShaderFeatureInfo const * feature_info, std::ostream& os, char const * comment)
 	{
 		static char const * feature_info_names[] =
@@ -94,7 +101,7 @@ namespace
 		os << comment << std::endl;
 	}
 
-	void PrintSignature(char const * name, DxilProgramSignature const * signature, bool is_input, std::ostream& os, char const * comment)
+	void PrintSignature(char const * name, DxilSignatureView const & signature, bool is_input, std::ostream& os, char const * comment)
 	{
 		static char const * sys_value_names[] =
 		{
@@ -144,21 +151,17 @@ namespace
 			<< comment << " Name                 Index   Mask Register SysValue  Format   Used" << std::endl
 			<< comment << " -------------------- ----- ------ -------- -------- ------- ------" << std::endl;
 
-		if (signature->ParamCount == 0)
+		if (signature.empty())
 		{
 			os << comment << " no parameters" << std::endl;
 			return;
 		}
 
-		auto sig_beg = ByteOffset<DxilProgramSignatureElement>(signature, signature->ParamOffset);
-		auto sig_end = sig_beg + signature->ParamCount;
-
-		bool has_streams = std::any_of(sig_beg, sig_end,
-			[](DxilProgramSignatureElement const & signature) { return signature.Stream != 0; });
-		for (auto sig = sig_beg; sig != sig_end; ++ sig)
+		bool const has_streams = signature.HasStreams();
+		for (auto sig = signature.begin(); sig != signature.end(); ++ sig)
 		{
 			os << comment << " ";
-			auto semantic_name = ByteOffset<char>(signature, sig->SemanticName);
+			std::string const semantic_name(signature.SemanticName(*sig));
 			if (has_streams)
 			{
 				os << "m" << sig->Stream << ":";
@@ -174,23 +177,23 @@ namespace
 			if (sig->Register == -1)
 			{
 				os << "    N/A";
-				if (!_stricmp(semantic_name, "SV_Depth"))
+				if (!_stricmp(semantic_name.c_str(), "SV_Depth"))
 				{
 					os << "   oDepth";
 				}
-				else if (0 == _stricmp(semantic_name, "SV_DepthGreaterEqual"))
+				else if (0 == _stricmp(semantic_name.c_str(), "SV_DepthGreaterEqual"))
 				{
 					os << " oDepthGE";
 				}
-				else if (0 == _stricmp(semantic_name, "SV_DepthLessEqual"))
+				else if (0 == _stricmp(semantic_name.c_str(), "SV_DepthLessEqual"))
 				{
 					os << " oDepthLE";
 				}
-				else if (0 == _stricmp(semantic_name, "SV_Coverage"))
+				else if (0 == _stricmp(semantic_name.c_str(), "SV_Coverage"))
 				{
 					os << "    oMask";
 				}
-				else if (0 == _stricmp(semantic_name, "SV_StencilRef"))
+				else if (0 == _stricmp(semantic_name.c_str(), "SV_StencilRef"))
 				{
 					os << "    oStencilRef";
 				}
@@ -372,123 +375,114 @@ namespace
 
 		os << comment << std::endl;
 	}
-}
-
-void Usage()
-{
-	std::cerr << "Dilithium DirectX Intermediate Language Disassembler." << std::endl;
-	std::cerr << "This program is free software, released under a MIT license" << std::endl;
-	std::cerr << std::endl;
-	std::cerr << "Usage: DilithiumDisasm INPUT [OUTPUT]" << std::endl;
-	std::cerr << std::endl;
-}
-
-std::vector<uint8_t> LoadProgramFromStream(std::istream& in)
-{
-	in.seekg(0, std::ios_base::end);
-	std::vector<uint8_t> program(in.tellg());
-	in.seekg(0, std::ios_base::beg);
-	in.read(reinterpret_cast<char*>(&program[0]), program.size());
-	return program;
-}
 
-std::string Disassemble(std::vector<uint8_t> const & program)
-{
-	std::ostringstream oss;
+	// The first part of each kind in a container.
+	typedef std::map<uint32_t, DxilPartHeader const *> DxilParts;
 
-	uint8_t const * il = program.data();
-	uint32_t il_length = static_cast<uint32_t>(program.size());
-	auto container = IsDxilContainerLike(il, il_length);
-	if (container)
+	// find_part(four_cc) returns the first part of that kind, or null.
+	template <typename FindPart>
+	void PrintContainerInfo(FindPart const & find_part, DxilProgramHeader const * program_header, std::ostream& os)
 	{
-		if (!IsValidDxilContainer(container, il_length))
+		auto part_data = [&find_part](uint32_t four_cc)
 		{
-			TERROR("This container is invalid.");
-		}
+			DxilPartHeader const * part = find_part(four_cc);
+			return part ? ArrayRef<uint8_t>(reinterpret_cast<uint8_t const *>(GetDxilPartData(part)), part->PartSize)
+				: ArrayRef<uint8_t>();
+		};
 
-		for (uint32_t i = 0; i < container->PartCount; ++ i)
+		auto part = find_part(DFCC_FeatureInfo);
+		if (part)
 		{
-			auto part = GetDxilContainerPart(container, i);
-			if (part->PartFourCC == DFCC_FeatureInfo)
-			{
-				PrintFeatureInfo(reinterpret_cast<DxilShaderFeatureInfo const *>(GetDxilPartData(part)), oss, ";");
-				break;
-			}
+			PrintFeatureInfo(reinterpret_cast<DxilShaderFeatureInfo const *>(GetDxilPartData(part)), os, ";");
 		}
-		for (uint32_t i = 0; i < container->PartCount; ++ i)
+		DxilSignatureView const input_signature(part_data(DFCC_InputSignature));
+		if (input_signature.Valid())
 		{
-			auto part = GetDxilContainerPart(container, i);
-			if (part->PartFourCC == DFCC_InputSignature)
-			{
-				PrintSignature("Input", reinterpret_cast<DxilProgramSignature const *>(GetDxilPartData(part)), true, oss, ";");
-				break;
-			}
+			PrintSignature("Input", input_signature, true, os, ";");
 		}
-		for (uint32_t i = 0; i < container->PartCount; ++ i)
+		DxilSignatureView const output_signature(part_data(DFCC_OutputSignature));
+		if (output_signature.Valid())
 		{
-			auto part = GetDxilContainerPart(container, i);
-			if (part->PartFourCC == DFCC_OutputSignature)
-			{
-				PrintSignature("Output", reinterpret_cast<DxilProgramSignature const *>(GetDxilPartData(part)), false, oss, ";");
-				break;
-			}
+			PrintSignature("Output", output_signature, false, os, ";");
 		}
-		for (uint32_t i = 0; i < container->PartCount; ++ i)
+		DxilSignatureView const patch_constant_signature(part_data(DFCC_PatchConstantSignature));
+		if (patch_constant_signature.Valid())
 		{
-			auto part = GetDxilContainerPart(container, i);
-			if (part->PartFourCC == DFCC_PatchConstantSignature)
-			{
-				PrintSignature("Patch Constant signature", reinterpret_cast<DxilProgramSignature const *>(GetDxilPartData(part)),
-					false, oss, ";");
-				break;
-			}
+			PrintSignature("Patch Constant signature", patch_constant_signature, false, os, ";");
 		}
-
-		uint32_t dxil_index = container->PartCount;
-		for (uint32_t i = 0; i < container->PartCount; ++ i)
+		part = find_part(DFCC_PipelineStateValidation);
+		if (part)
 		{
-			auto part = GetDxilContainerPart(container, i);
-			if (part->PartFourCC == DFCC_DXIL)
-			{
-				dxil_index = i;
-				break;
-			}
+			PrintPipelineStateValidationRuntimeInfo(GetDxilPartData(part), GetVersionShaderType(program_header->ProgramVersion),
+				os, ";");
 		}
+	}
+
+	void PrintModule(LLVMModule& module, std::ostream& os)
+	{
+		DILITHIUM_UNUSED(os);
 
-		if (dxil_index == container->PartCount)
+		if (module.GetNamedMetadata("dx.version"))
 		{
-			TERROR("This container doesn't have DXIL.");
+			auto& dxil_module = module.GetOrCreateDxilModule();
+			DILITHIUM_UNUSED(dxil_module);
 		}
 
-		for (uint32_t i = 0; i < container->PartCount; ++ i)
+		//DILITHIUM_NOT_IMPLEMENTED;
+	}
+
+	bool ReadBytes(std::istream& in, void* data, uint32_t size)
+	{
+		in.read(static_cast<char*>(data), size);
+		return static_cast<uint32_t>(in.gcount()) == size;
+	}
+
+	bool SkipBytes(std::istream& in, uint32_t size)
+	{
+		in.ignore(size);
+		return static_cast<uint32_t>(in.gcount()) == size;
+	}
+}
+
+void Usage()
+{
+	std::cerr << "Dilithium DirectX Intermediate Language Disassembler." << std::endl;
+	std::cerr << "This program is free software, released under a MIT license" << std::endl;
+	std::cerr << std::endl;
+	std::cerr << "Usage: DilithiumDisasm INPUT [OUTPUT]" << std::endl;
+	std::cerr << std::endl;
+	std::cerr << "INPUT can be - to read a container from the standard input, as it arrives." << std::endl;
+	std::cerr << std::endl;
+}
+
+// If the program lies in a mapped file, the module is read from it directly.
+std::string Disassemble(uint8_t const * program, uint32_t program_length, std::shared_ptr<MappedFile> const & file = nullptr)
+{
+	std::ostringstream oss;
+
+	uint8_t const * il = program;
+	uint32_t il_length = program_length;
+	if (IsDxilContainerLike(il, il_length))
+	{
+		DxilContainerView const container(il, il_length);
+		if (!container.Valid())
 		{
-			auto part = GetDxilContainerPart(container, i);
-			if (part->PartFourCC == DFCC_ShaderDebugInfoDXIL)
-			{
-				// Use dbg module if exist.
-				dxil_index = i;
-				break;
-			}
+			TERROR("This container is invalid.");
 		}
-
-		auto dxil_part = GetDxilContainerPart(container, dxil_index);
-		auto program_header = reinterpret_cast<DxilProgramHeader const *>(GetDxilPartData(dxil_part));
-		if (!IsValidDxilProgramHeader(program_header, dxil_part->PartSize))
+		if (!container.FindPart(DFCC_DXIL))
 		{
-			TERROR("The program header in this is container is invalid.");
+			TERROR("This container doesn't have DXIL.");
 		}
 
-		for (uint32_t i = 0; i < container->PartCount; ++ i)
+		// Use dbg module if exist.
+		auto program_header = container.Program();
+		if (!program_header)
 		{
-			auto part = GetDxilContainerPart(container, i);
-			if (part->PartFourCC == DFCC_PipelineStateValidation)
-			{
-				PrintPipelineStateValidationRuntimeInfo(GetDxilPartData(part), GetVersionShaderType(program_header->ProgramVersion),
-					oss, ";");
-				break;
-			}
+			TERROR("The program header in this is container is invalid.");
 		}
 
+		PrintContainerInfo([&container](uint32_t four_cc) { return container.FindPart(four_cc); }, program_header, oss);
+
 		GetDxilProgramBitcode(program_header, &il, &il_length);
 	}
 	else
@@ -502,14 +496,136 @@ std::string Disassemble(std::vector<uint8_t> const & program)
 
 	try
 	{
-		auto module = Dilithium::LoadLLVMModule(il, il_length, "");
-		if (module->GetNamedMetadata("dx.version"))
+		auto module = Dilithium::LoadLLVMModule(file ? BitcodeSource(file, il, il_length) : BitcodeSource(il, il_length), "");
+		PrintModule(*module, oss);
+
+		return oss.str();
+	}
+	catch (std::error_code& ec)
+	{
+		std::cerr << ec.message() << std::endl;
+		return "";
+	}
+}
+
+// Disassembles a container as it comes in, without ever holding the whole of it. The bitcode of the program part is
+// parsed straight from the input, the other parts are kept only if they get printed. Since the parts have to be read in
+// order, a debug program part is only preferred over the DXIL one if it comes first, as compilers put it.
+std::string DisassembleStream(std::istream& in)
+{
+	uint32_t four_cc;
+	if (!ReadBytes(in, &four_cc, sizeof(four_cc)))
+	{
+		TERROR("The input is empty.");
+	}
+
+	if (four_cc != DFCC_Container)
+	{
+		// The size of bare bitcode isn't known up front, so fall back to reading it all.
+		std::vector<uint8_t> program(reinterpret_cast<uint8_t const *>(&four_cc),
+			reinterpret_cast<uint8_t const *>(&four_cc) + sizeof(four_cc));
+		program.insert(program.end(), std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+		return Disassemble(program.data(), static_cast<uint32_t>(program.size()));
+	}
+
+	DxilContainerHeader container;
+	container.HeaderFourCC = four_cc;
+	if (!ReadBytes(in, reinterpret_cast<uint8_t*>(&container) + sizeof(four_cc), sizeof(container) - sizeof(four_cc))
+		|| (container.Version.Major != DxilContainerVersionMajor)
+		|| (container.ContainerSizeInBytes > DxilContainerMaxSize)
+		|| (sizeof(uint32_t) * container.PartCount + sizeof(DxilContainerHeader) > container.ContainerSizeInBytes))
+	{
+		TERROR("This container is invalid.");
+	}
+
+	std::vector<uint32_t> part_offsets(container.PartCount);
+	if (!ReadBytes(in, part_offsets.data(), static_cast<uint32_t>(part_offsets.size() * sizeof(uint32_t))))
+	{
+		TERROR("This container is invalid.");
+	}
+	std::sort(part_offsets.begin(), part_offsets.end());
+
+	static uint32_t const printed_parts[] =
+	{
+		DFCC_FeatureInfo,
+		DFCC_InputSignature,
+		DFCC_OutputSignature,
+		DFCC_PatchConstantSignature,
+		DFCC_PipelineStateValidation
+	};
+
+	std::ostringstream oss;
+	try
+	{
+		std::vector<std::vector<uint8_t>> part_storage;
+		DxilParts parts;
+		DxilProgramHeader program_header;
+		std::unique_ptr<LLVMModule> module;
+
+		uint32_t pos = static_cast<uint32_t>(sizeof(DxilContainerHeader) + part_offsets.size() * sizeof(uint32_t));
+		for (auto offset : part_offsets)
 		{
-			auto& dxil_module = module->GetOrCreateDxilModule();
-			DILITHIUM_UNUSED(dxil_module);
+			DxilPartHeader part_header;
+			if ((offset < pos) || (offset > container.ContainerSizeInBytes - sizeof(DxilPartHeader))
+				|| !SkipBytes(in, offset - pos) || !ReadBytes(in, &part_header, sizeof(part_header))
+				|| (offset + sizeof(DxilPartHeader) + part_header.PartSize > container.ContainerSizeInBytes))
+			{
+				TERROR("This container is invalid, or has overlapping parts.");
+			}
+			pos = offset + sizeof(DxilPartHeader);
+
+			uint32_t part_bytes_left = part_header.PartSize;
+			if (((part_header.PartFourCC == DFCC_ShaderDebugInfoDXIL) || (part_header.PartFourCC == DFCC_DXIL)) && !module)
+			{
+				if ((part_header.PartSize < sizeof(program_header)) || !ReadBytes(in, &program_header, sizeof(program_header))
+					|| !IsValidDxilProgramHeader(&program_header, part_header.PartSize))
+				{
+					TERROR("The program header in this is container is invalid.");
+				}
+
+				uint32_t const bitcode_offset = offsetof(DxilProgramHeader, BitcodeHeader) + program_header.BitcodeHeader.BitcodeOffset;
+				if ((bitcode_offset < sizeof(program_header)) || !SkipBytes(in, bitcode_offset - sizeof(program_header)))
+				{
+					TERROR("The program header in this is container is invalid.");
+				}
+
+				module = Dilithium::LoadLLVMModule(BitcodeSource(in, program_header.BitcodeHeader.BitcodeSize), "");
+
+				// The parser stops right after the bitcode.
+				part_bytes_left -= bitcode_offset + program_header.BitcodeHeader.BitcodeSize;
+			}
+			else if (std::find(std::begin(printed_parts), std::end(printed_parts), part_header.PartFourCC) != std::end(printed_parts))
+			{
+				part_storage.emplace_back(sizeof(DxilPartHeader) + part_header.PartSize);
+				auto& data = part_storage.back();
+				std::memcpy(data.data(), &part_header, sizeof(part_header));
+				if (!ReadBytes(in, data.data() + sizeof(DxilPartHeader), part_header.PartSize))
+				{
+					TERROR("This container is invalid.");
+				}
+				parts.emplace(part_header.PartFourCC, reinterpret_cast<DxilPartHeader const *>(data.data()));
+				part_bytes_left = 0;
+			}
+
+			if (!SkipBytes(in, part_bytes_left))
+			{
+				TERROR("This container is invalid.");
+			}
+			pos += part_header.PartSize;
 		}
 
-		//DILITHIUM_NOT_IMPLEMENTED;
+		if (!module)
+		{
+			TERROR("This container doesn't have DXIL.");
+		}
+
+		PrintContainerInfo([&parts](uint32_t four_cc) -> DxilPartHeader const *
+			{
+				auto iter = parts.find(four_cc);
+				return (iter != parts.end()) ? iter->second : nullptr;
+			},
+			&program_header, oss);
+		PrintModule(*module, oss);
 
 		return oss.str();
 	}
@@ -528,11 +644,23 @@ int main(int argc, char** argv)
 		return 1;
 	}
 
-	std::ifstream in(argv[1], std::ios_base::in | std::ios_base::binary);
-	auto program = LoadProgramFromStream(in);
-	in.close();
-
-	auto text = Disassemble(program);
+	std::string text;
+	if (std::string(argv[1]) == "-")
+	{
+#ifdef _WIN32
+		_setmode(_fileno(stdin), _O_BINARY);
+#endif
+		text = DisassembleStream(std::cin);
+	}
+	else
+	{
+		auto file = std::make_shared<MappedFile>(argv[1]);
+		if (file->Size() > DxilContainerMaxSize)
+		{
+			TERROR("The input is too large.");
+		}
+		text = Disassemble(file->Data(), static_cast<uint32_t>(file->Size()), file);
+	}
 
 	std::ofstream out;
 	bool screen_only = false;
@@ -0,0 +1,676 @@
+/**
+ * @file DilithiumScan.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of Dilithium
+ * For the latest info, see https://github.com/gongminmin/Dilithium
+ *
+ * @section LICENSE
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Minmin Gong. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files(the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions :
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <iomanip>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <cstdio>
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include <boost/endian/conversion.hpp>
+
+#include <Dilithium/Dilithium.hpp>
+#include <Dilithium/LLVMModule.hpp>
+#include <Dilithium/ThreadGroup.hpp>
+#include <Dilithium/dxc/HLSL/DxilCBuffer.hpp>
+#include <Dilithium/dxc/HLSL/DxilContainer.hpp>
+#include <Dilithium/dxc/HLSL/DxilContainerReflection.hpp>
+#include <Dilithium/dxc/HLSL/DxilModule.hpp>
+#include <Dilithium/dxc/HLSL/DxilReflectionCache.hpp>
+#include <Dilithium/dxc/HLSL/DxilResource.hpp>
+#include <Dilithium/dxc/HLSL/DxilSampler.hpp>
+
+using namespace Dilithium;
+
+// One record is written per shader, in the order of the paths. A JSON record is an object on a line of its own. A binary
+// record is little endian, with strings stored as a uint16_t length followed by the characters:
+//   uint32_t   size of the rest of the record
+//   string     path
+//   string     error, empty on success. Nothing else follows if it isn't.
+//   uint8_t    hash[16]
+//   uint8_t    shader kind, shader model major, shader model minor
+//   uint64_t   feature flags
+//   3 x        input, output and patch constant signature:
+//     uint32_t   number of elements
+//     element    string semantic name, uint32_t semantic index, register, stream, uint8_t mask, always reads or never
+//                writes mask, system value, component type
+//   string     resource error, empty unless the resources couldn't be loaded
+//   uint32_t   number of resources, 0xFFFFFFFF if they weren't loaded
+//   resource   uint8_t class, kind, uint32_t ID, space, lower bound, range size, string name
+
+namespace
+{
+	struct SignatureElementRecord
+	{
+		std::string semantic_name;
+		uint32_t semantic_index;
+		uint32_t reg;
+		uint32_t stream;
+		uint8_t mask;
+		uint8_t rw_mask;
+		uint8_t system_value;
+		uint8_t comp_type;
+	};
+
+	struct ResourceRecord
+	{
+		uint8_t res_class;
+		uint8_t kind;
+		uint32_t id;
+		uint32_t space;
+		uint32_t lower_bound;
+		uint32_t range_size;
+		std::string name;
+	};
+
+	struct ShaderRecord
+	{
+		std::string path;
+		std::string error;
+
+		DxilContainerHash hash;
+		ShaderKind kind;
+		uint32_t shader_model_major;
+		uint32_t shader_model_minor;
+		uint64_t feature_flags;
+		std::vector<SignatureElementRecord> signatures[3];
+
+		bool has_resources = false;
+		std::string resource_error;
+		std::vector<ResourceRecord> resources;
+	};
+
+	char const * signature_names[] = { "input", "output", "patch_constant" };
+
+	bool HasCsoExtension(std::string const & name)
+	{
+		if (name.size() < 4)
+		{
+			return false;
+		}
+		std::string ext = name.substr(name.size() - 4);
+		std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return static_cast<char>(::tolower(c)); });
+		return ext == ".cso";
+	}
+
+	bool IsDirectory(std::string const & path)
+	{
+#ifdef _WIN32
+		DWORD const attrs = ::GetFileAttributesA(path.c_str());
+		return (attrs != INVALID_FILE_ATTRIBUTES) && (attrs & FILE_ATTRIBUTE_DIRECTORY);
+#else
+		struct stat st;
+		return (::stat(path.c_str(), &st) == 0) && S_ISDIR(st.st_mode);
+#endif
+	}
+
+	// Appends the .cso files under dir, recursively.
+	void ListShaders(std::string const & dir, std::vector<std::string>& paths)
+	{
+#ifdef _WIN32
+		WIN32_FIND_DATAA find_data;
+		HANDLE find = ::FindFirstFileA((dir + "\\*").c_str(), &find_data);
+		if (find == INVALID_HANDLE_VALUE)
+		{
+			return;
+		}
+		do
+		{
+			std::string const name = find_data.cFileName;
+			if ((name == ".") || (name == ".."))
+			{
+				continue;
+			}
+			std::string const path = dir + "\\" + name;
+			if (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			{
+				ListShaders(path, paths);
+			}
+			else if (HasCsoExtension(name))
+			{
+				paths.push_back(path);
+			}
+		} while (::FindNextFileA(find, &find_data));
+		::FindClose(find);
+#else
+		DIR* d = ::opendir(dir.c_str());
+		if (!d)
+		{
+			return;
+		}
+		while (dirent* entry = ::readdir(d))
+		{
+			std::string const name = entry->d_name;
+			if ((name == ".") || (name == ".."))
+			{
+				continue;
+			}
+			std::string const path = dir + "/" + name;
+			if (IsDirectory(path))
+			{
+				ListShaders(path, paths);
+			}
+			else if (HasCsoExtension(name))
+			{
+				paths.push_back(path);
+			}
+		}
+		::closedir(d);
+#endif
+	}
+
+	void AddSignature(DxilSignatureView const & signature, std::vector<SignatureElementRecord>& elements)
+	{
+		for (auto const & element : signature)
+		{
+			SignatureElementRecord rec;
+			rec.semantic_name = std::string(signature.SemanticName(element));
+			rec.semantic_index = element.SemanticIndex;
+			rec.reg = element.Register;
+			rec.stream = element.Stream;
+			rec.mask = element.Mask;
+			rec.rw_mask = element.AlwaysReads_Mask;
+			rec.system_value = static_cast<uint8_t>(element.SystemValue);
+			rec.comp_type = static_cast<uint8_t>(element.CompType);
+			elements.push_back(std::move(rec));
+		}
+	}
+
+	template <typename T>
+	void AddResources(std::vector<std::unique_ptr<T>> const & resources, std::vector<ResourceRecord>& records)
+	{
+		for (auto const & res : resources)
+		{
+			ResourceRecord rec;
+			rec.res_class = static_cast<uint8_t>(res->GetClass());
+			rec.kind = static_cast<uint8_t>(res->GetKind());
+			rec.id = res->GetID();
+			rec.space = res->GetSpaceID();
+			rec.lower_bound = res->GetLowerBound();
+			rec.range_size = res->GetRangeSize();
+			rec.name = res->GetGlobalName();
+			records.push_back(std::move(rec));
+		}
+	}
+
+	std::string ErrorMessage(std::exception const & ex)
+	{
+		std::string message = ex.what();
+		if (message.empty())
+		{
+			message = "Unknown error";
+		}
+		return message;
+	}
+
+	// The resources are only in the metadata of the program, so the module-level blocks have to be parsed for them,
+	// unless the cache has a record of the shader. Reading a record never parses the program, so cache hits give the
+	// resources in every build.
+	void LoadResources(ShaderRecord& record, DxilContainerFileView const & file, DxilReflectionCache const * cache)
+	{
+		DxilReflectionRecord cached;
+		if (cache)
+		{
+			cached = DILITHIUM_UNREACHABLE_THROWS ? cache->GetOrCreate(file) : cache->Find(record.hash);
+		}
+
+		if (cached.Valid())
+		{
+			for (auto const & res : cached.Resources())
+			{
+				ResourceRecord rec;
+				rec.res_class = res.Class;
+				rec.kind = res.Kind;
+				rec.id = res.ID;
+				rec.space = res.Space;
+				rec.lower_bound = res.LowerBound;
+				rec.range_size = res.RangeSize;
+				rec.name = std::string(cached.ResourceName(res));
+				record.resources.push_back(std::move(rec));
+			}
+		}
+		else if (DILITHIUM_UNREACHABLE_THROWS)
+		{
+			auto module = file.LoadModule("", DxilContainerFileView::LoadMode::WithoutBodies);
+			auto const & dxil_module = module->GetOrCreateDxilModule();
+			AddResources(dxil_module.GetSRVs(), record.resources);
+			AddResources(dxil_module.GetUAVs(), record.resources);
+			AddResources(dxil_module.GetCBuffers(), record.resources);
+			AddResources(dxil_module.GetSamplers(), record.resources);
+		}
+		else
+		{
+			// Unsupported inputs wouldn't throw, so the program isn't parsed at all.
+			record.resource_error = "This build doesn't parse programs, only cache records give the resources.";
+			return;
+		}
+		record.has_resources = true;
+	}
+
+	// Everything but the resources comes from the parts of the container.
+	void ScanShader(ShaderRecord& record, DxilReflectionCache const * cache)
+	{
+		DxilContainerFileView const file(record.path);
+		if (!file.Container())
+		{
+			TERROR("This isn't a valid container.");
+		}
+
+		DxilContainerReflection const reflection(file.ContainerView());
+		record.hash = file.Container()->Hash;
+		// The kind is whatever the program header says, so a corrupt one can be out of range.
+		record.kind = std::min(reflection.GetShaderKind(), ShaderKind::Invalid);
+		record.shader_model_major = reflection.ShaderModelMajor();
+		record.shader_model_minor = reflection.ShaderModelMinor();
+		record.feature_flags = reflection.FeatureFlags();
+		AddSignature(reflection.InputSignature(), record.signatures[0]);
+		AddSignature(reflection.OutputSignature(), record.signatures[1]);
+		AddSignature(reflection.PatchConstantSignature(), record.signatures[2]);
+
+		// A failure past this point only loses the resources.
+		try
+		{
+			LoadResources(record, file, cache);
+		}
+		catch (std::exception& ex)
+		{
+			record.has_resources = false;
+			record.resources.clear();
+			record.resource_error = ErrorMessage(ex);
+		}
+	}
+
+	std::string JsonString(std::string const & str)
+	{
+		std::ostringstream oss;
+		oss << '"';
+		for (char c : str)
+		{
+			switch (c)
+			{
+			case '"':
+				oss << "\\\"";
+				break;
+			case '\\':
+				oss << "\\\\";
+				break;
+			case '\n':
+				oss << "\\n";
+				break;
+			case '\r':
+				oss << "\\r";
+				break;
+			case '\t':
+				oss << "\\t";
+				break;
+
+			default:
+				if (static_cast<uint8_t>(c) < 0x20)
+				{
+					oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<uint32_t>(c)
+						<< std::dec << std::setfill(' ');
+				}
+				else
+				{
+					oss << c;
+				}
+				break;
+			}
+		}
+		oss << '"';
+		return oss.str();
+	}
+
+	std::string FormatJson(ShaderRecord const & record)
+	{
+		static char const * shader_kind_names[] = { "ps", "vs", "gs", "hs", "ds", "cs", "invalid" };
+
+		std::ostringstream oss;
+		oss << "{\"path\":" << JsonString(record.path);
+		if (!record.error.empty())
+		{
+			oss << ",\"error\":" << JsonString(record.error) << "}";
+			return oss.str();
+		}
+
+		oss << ",\"hash\":\"" << std::hex << std::setfill('0');
+		for (auto digit : record.hash.Digest)
+		{
+			oss << std::setw(2) << static_cast<uint32_t>(digit);
+		}
+		oss << std::dec << std::setfill(' ') << "\"";
+		oss << ",\"stage\":\"" << shader_kind_names[static_cast<uint32_t>(record.kind)] << "\"";
+		oss << ",\"shader_model\":\"" << record.shader_model_major << "_" << record.shader_model_minor << "\"";
+		oss << ",\"feature_flags\":" << record.feature_flags;
+
+		for (uint32_t i = 0; i < 3; ++ i)
+		{
+			oss << ",\"" << signature_names[i] << "\":[";
+			for (size_t j = 0; j < record.signatures[i].size(); ++ j)
+			{
+				auto const & element = record.signatures[i][j];
+				oss << (j ? "," : "") << "{\"name\":" << JsonString(element.semantic_name)
+					<< ",\"index\":" << element.semantic_index
+					<< ",\"register\":" << static_cast<int32_t>(element.reg)
+					<< ",\"stream\":" << element.stream
+					<< ",\"mask\":" << static_cast<uint32_t>(element.mask)
+					<< ",\"rw_mask\":" << static_cast<uint32_t>(element.rw_mask)
+					<< ",\"system_value\":" << static_cast<uint32_t>(element.system_value)
+					<< ",\"comp_type\":" << static_cast<uint32_t>(element.comp_type) << "}";
+			}
+			oss << "]";
+		}
+
+		if (!record.resource_error.empty())
+		{
+			oss << ",\"resource_error\":" << JsonString(record.resource_error);
+		}
+		if (record.has_resources)
+		{
+			static char const * res_class_names[] = { "srv", "uav", "cbuffer", "sampler", "invalid" };
+
+			oss << ",\"resources\":[";
+			for (size_t i = 0; i < record.resources.size(); ++ i)
+			{
+				auto const & res = record.resources[i];
+				oss << (i ? "," : "") << "{\"class\":\"" << res_class_names[std::min<uint32_t>(res.res_class, 4)] << "\""
+					<< ",\"kind\":" << static_cast<uint32_t>(res.kind)
+					<< ",\"id\":" << res.id
+					<< ",\"space\":" << res.space
+					<< ",\"lower_bound\":" << res.lower_bound
+					<< ",\"range_size\":" << res.range_size
+					<< ",\"name\":" << JsonString(res.name) << "}";
+			}
+			oss << "]";
+		}
+
+		oss << "}";
+		return oss.str();
+	}
+
+	class BinaryWriter
+	{
+	public:
+		explicit BinaryWriter(std::string& out)
+			: out_(out)
+		{
+		}
+
+		void U8(uint8_t v)
+		{
+			out_.push_back(static_cast<char>(v));
+		}
+		void U16(uint16_t v)
+		{
+			v = boost::endian::native_to_little(v);
+			out_.append(reinterpret_cast<char const *>(&v), sizeof(v));
+		}
+		void U32(uint32_t v)
+		{
+			v = boost::endian::native_to_little(v);
+			out_.append(reinterpret_cast<char const *>(&v), sizeof(v));
+		}
+		void U64(uint64_t v)
+		{
+			v = boost::endian::native_to_little(v);
+			out_.append(reinterpret_cast<char const *>(&v), sizeof(v));
+		}
+		void String(std::string const & str)
+		{
+			uint16_t const length = static_cast<uint16_t>(std::min<size_t>(str.size(), UINT16_MAX));
+			this->U16(length);
+			out_.append(str.data(), length);
+		}
+
+	private:
+		std::string& out_;
+	};
+
+	std::string FormatBinary(ShaderRecord const & record)
+	{
+		std::string out;
+		BinaryWriter writer(out);
+		writer.U32(0);
+		writer.String(record.path);
+		writer.String(record.error);
+		if (record.error.empty())
+		{
+			out.append(reinterpret_cast<char const *>(record.hash.Digest), sizeof(record.hash.Digest));
+			writer.U8(static_cast<uint8_t>(record.kind));
+			writer.U8(static_cast<uint8_t>(record.shader_model_major));
+			writer.U8(static_cast<uint8_t>(record.shader_model_minor));
+			writer.U64(record.feature_flags);
+
+			for (auto const & elements : record.signatures)
+			{
+				writer.U32(static_cast<uint32_t>(elements.size()));
+				for (auto const & element : elements)
+				{
+					writer.String(element.semantic_name);
+					writer.U32(element.semantic_index);
+					writer.U32(element.reg);
+					writer.U32(element.stream);
+					writer.U8(element.mask);
+					writer.U8(element.rw_mask);
+					writer.U8(element.system_value);
+					writer.U8(element.comp_type);
+				}
+			}
+
+			writer.String(record.resource_error);
+			writer.U32(record.has_resources ? static_cast<uint32_t>(record.resources.size()) : 0xFFFFFFFFU);
+			for (auto const & res : record.resources)
+			{
+				writer.U8(res.res_class);
+				writer.U8(res.kind);
+				writer.U32(res.id);
+				writer.U32(res.space);
+				writer.U32(res.lower_bound);
+				writer.U32(res.range_size);
+				writer.String(res.name);
+			}
+		}
+
+		uint32_t const size = boost::endian::native_to_little(static_cast<uint32_t>(out.size() - sizeof(uint32_t)));
+		std::memcpy(&out[0], &size, sizeof(size));
+		return out;
+	}
+}
+
+void Usage()
+{
+	std::cerr << "Dilithium DXIL container scanner." << std::endl;
+	std::cerr << "This program is free software, released under a MIT license" << std::endl;
+	std::cerr << std::endl;
+	std::cerr << "Usage: DilithiumScan [-j THREADS] [-b] [-c CACHE] [-o OUTPUT] INPUT..." << std::endl;
+	std::cerr << std::endl;
+	std::cerr << "INPUT is a container, or a directory searched recursively for .cso files." << std::endl;
+	std::cerr << "-j sets the number of worker threads, one per hardware thread by default." << std::endl;
+	std::cerr << "-b writes binary records instead of JSON lines." << std::endl;
+	std::cerr << "-c keeps the reflection of each shader in the CACHE directory, keyed by the container hash, so" << std::endl;
+	std::cerr << "   unchanged shaders aren't decoded again. Release builds only read the records already there." << std::endl;
+	if (!DILITHIUM_UNREACHABLE_THROWS)
+	{
+		std::cerr << std::endl;
+		std::cerr << "This build doesn't parse programs. The resources of a shader are only given if the cache has a record" << std::endl;
+		std::cerr << "of it, otherwise its resource_error says they are missing." << std::endl;
+	}
+	std::cerr << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t num_threads = std::max(std::thread::hardware_concurrency(), 1U);
+	bool binary = false;
+	std::string output;
+	std::string cache_dir;
+	std::vector<std::string> paths;
+	for (int i = 1; i < argc; ++ i)
+	{
+		std::string arg = argv[i];
+		if ((arg == "-j") && (i + 1 < argc))
+		{
+			++ i;
+			num_threads = std::max(static_cast<uint32_t>(std::stoul(argv[i])), 1U);
+			continue;
+		}
+		if ((arg == "-o") && (i + 1 < argc))
+		{
+			++ i;
+			output = argv[i];
+			continue;
+		}
+		if ((arg == "-c") && (i + 1 < argc))
+		{
+			++ i;
+			cache_dir = argv[i];
+			continue;
+		}
+		if (arg == "-b")
+		{
+			binary = true;
+			continue;
+		}
+
+		if (IsDirectory(arg))
+		{
+			std::vector<std::string> dir_paths;
+			ListShaders(arg, dir_paths);
+			std::sort(dir_paths.begin(), dir_paths.end());
+			paths.insert(paths.end(), dir_paths.begin(), dir_paths.end());
+		}
+		else
+		{
+			paths.push_back(arg);
+		}
+	}
+
+	if (paths.empty())
+	{
+		Usage();
+		return 1;
+	}
+
+	// Every worker takes the next shader until there is none left. Each module gets a context of its own, on top of
+	// the DXIL prelude all of them share.
+	std::unique_ptr<DxilReflectionCache> cache;
+	if (!cache_dir.empty())
+	{
+		cache = std::make_unique<DxilReflectionCache>(cache_dir);
+		if (!DILITHIUM_UNREACHABLE_THROWS)
+		{
+			std::cerr << "Warning: This build doesn't parse programs. Shaders without a record in " << cache_dir
+				<< " have no resources, and no records are added." << std::endl;
+		}
+	}
+
+	std::vector<std::string> results(paths.size());
+	std::atomic<uint32_t> next_shader(0);
+	auto scan = [&paths, &results, &next_shader, &cache, binary]
+	{
+		for (uint32_t i = next_shader ++; i < paths.size(); i = next_shader ++)
+		{
+			ShaderRecord record;
+			record.path = paths[i];
+			try
+			{
+				ScanShader(record, cache.get());
+			}
+			catch (std::exception& ex)
+			{
+				record.error = ErrorMessage(ex);
+			}
+			results[i] = binary ? FormatBinary(record) : FormatJson(record) + "\n";
+		}
+	};
+
+	num_threads = std::min(num_threads, static_cast<uint32_t>(paths.size()));
+	{
+		ThreadGroup workers;
+		for (uint32_t i = 1; i < num_threads; ++ i)
+		{
+			if (!workers.Spawn(scan))
+			{
+				break;
+			}
+		}
+		scan();
+	}
+
+	std::ofstream out_file;
+	if (!output.empty())
+	{
+		out_file.open(output, binary ? std::ios_base::binary : std::ios_base::out);
+		if (!out_file)
+		{
+			std::cerr << "Couldn't open " << output << std::endl;
+			return 1;
+		}
+	}
+#ifdef _WIN32
+	else if (binary)
+	{
+		_setmode(_fileno(stdout), _O_BINARY);
+	}
+#endif
+
+	std::ostream& out = output.empty() ? std::cout : out_file;
+	for (auto const & result : results)
+	{
+		out << result;
+	}
+
+	return 0;
+}